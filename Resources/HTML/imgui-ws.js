@@ -10,10 +10,26 @@ const EventType = {
     TakeControl : '11 ',
     PasteClipboard : '12 ',
     InputText : '13 ',
+    ReplayControl : '14 ',
+};
+
+// ImGuiWS::FEvent::EReplayCommand
+const ReplayCommand = {
+    Play : 0,
+    Pause : 1,
+    Seek : 2,
+};
+
+// payload of imgui.texture_data, ImGuiWS::FTexture::Codec
+const TextureCodec = {
+    Raw : 0,
+    PNG : 1,
+    JPEG : 2,
 };
 
 const ServerEventType = {
     SetClipboardText : 0,
+    RemoveTexture : 1,
 };
 
 var imgui_ws = {
@@ -33,9 +49,23 @@ var imgui_ws = {
     tex_map_id: {},
     tex_map_rev: {},
     tex_map_abuf: {},
+    tex_map_type: {},
+    // revision being decoded by the browser
+    tex_map_decoding: {},
+
+    // IndexedDB of texture payloads by content hash, null while opening, false when unavailable
+    tex_cache_db: null,
+    tex_cache_lookups: {},
+    k_tex_cache_max_entries: 64,
+    // bound for textures still streaming in
+    tex_placeholder: null,
 
     n_draw_lists: null,
     draw_lists_abuf: {},
+    draw_lists_changed_ms: {},
+
+    // keep requesting a draw list for a while after it changed, so animated windows don't wait a request round trip
+    k_draw_list_hot_ms: 500,
 
     io: {
         mouse_x: 0.0,
@@ -47,9 +77,49 @@ var imgui_ws = {
 
     isComposing: false,
 
+    // encodes an input event, fields are described by format: 'i' int32, 'f' float32, 's' utf8 text (last field only)
+    // binary layout: [uint8 0x81][uint8 event type][2 bytes padding][fields], little endian
+    send_input: function(event_type, format, ...args) {
+        if (!incppect.k_binary_protocol) {
+            incppect.send(event_type + args.join(' '));
+            return;
+        }
+
+        let text = null;
+        let size = 4;
+        for (let i = 0; i < format.length; ++i) {
+            if (format[i] === 's') {
+                text = new TextEncoder().encode(args[i]);
+                size += text.length;
+            } else {
+                size += 4;
+            }
+        }
+
+        const payload = new Uint8Array(size);
+        const view = new DataView(payload.buffer);
+        payload[0] = 0x81;
+        payload[1] = parseInt(event_type);
+        let offset = 4;
+        for (let i = 0; i < format.length; ++i) {
+            switch (format[i]) {
+                case 'i': view.setInt32(offset, args[i], true); offset += 4; break;
+                case 'f': view.setFloat32(offset, args[i], true); offset += 4; break;
+                case 's': payload.set(text, offset); offset += text.length; break;
+            }
+        }
+        incppect.send_abuf(payload);
+    },
+
+    // controls the replay of the playback server, frame is only used by ReplayCommand.Seek
+    replay_control: function(command, frame) {
+        this.send_input(EventType.ReplayControl, 'ii', command, frame || 0);
+    },
+
     init: function(incppect, canvas_name, virtual_input_name) {
         this.canvas = document.getElementById(canvas_name);
         this.virtual_input = document.getElementById(virtual_input_name);
+        this.tex_cache_open();
 
         //this.canvas.style.touchAction = 'none'; // Disable browser handling of all panning and zooming gestures.
         //this.canvas.addEventListener('blur', this.canvas_on_blur);
@@ -69,6 +139,9 @@ var imgui_ws = {
                     let clipboard_text = incppect.abut_to_str(payload);
                     navigator.clipboard.writeText(clipboard_text);
                     break;
+                case ServerEventType.RemoveTexture:
+                    imgui_ws.remove_tex(new Uint32Array(payload)[0]);
+                    break;
                 default:
                     console.error("to server event %s not handle", event_id);
             }
@@ -78,7 +151,7 @@ var imgui_ws = {
             if (event.keyCode === ctrlKey || event.keyCode === cmdKey) {
                 ctrlDown = false;
             }
-            incppect.send(EventType.KeyUp + event.keyCode);
+            this.send_input(EventType.KeyUp, 'i', event.keyCode);
         };
         this.canvas.addEventListener('keyup', onkeyup, true);
         let onkeydown = (event) => {
@@ -92,17 +165,17 @@ var imgui_ws = {
 
             if (ctrlDown && event.keyCode === vKey) {
                 navigator.clipboard.readText().then(text => {
-                    incppect.send(EventType.PasteClipboard + text)
-                    incppect.send(EventType.KeyDown + event.keyCode);
+                    this.send_input(EventType.PasteClipboard, 's', text);
+                    this.send_input(EventType.KeyDown, 'i', event.keyCode);
                 })
             }
             else {
-                incppect.send(EventType.KeyDown + event.keyCode);
+                this.send_input(EventType.KeyDown, 'i', event.keyCode);
             }
         };
         this.canvas.addEventListener('keydown', onkeydown, true);
         this.canvas.addEventListener('keypress', (event) => {
-            incppect.send(EventType.KeyPress + event.keyCode);
+            this.send_input(EventType.KeyPress, 'i', event.keyCode);
 
             if (this.io.want_capture_keyboard) {
                 event.preventDefault();
@@ -113,7 +186,7 @@ var imgui_ws = {
             this.io.mouse_x = event.offsetX * window.devicePixelRatio;
             this.io.mouse_y = event.offsetY * window.devicePixelRatio;
 
-            incppect.send(EventType.MouseMove + this.io.mouse_x + ' ' + this.io.mouse_y);
+            this.send_input(EventType.MouseMove, 'ff', this.io.mouse_x, this.io.mouse_y);
 
             if (this.io.want_capture_mouse) {
                 event.preventDefault();
@@ -126,13 +199,13 @@ var imgui_ws = {
             this.io.mouse_x = event.offsetX * window.devicePixelRatio;
             this.io.mouse_y = event.offsetY * window.devicePixelRatio;
 
-            incppect.send(EventType.MouseDown + event.button + ' ' + this.io.mouse_x + ' ' + this.io.mouse_y);
+            this.send_input(EventType.MouseDown, 'iff', event.button, this.io.mouse_x, this.io.mouse_y);
         };
         this.canvas.addEventListener('pointerdown', onpointerdown);
         this.canvas.addEventListener('mousedown', onpointerdown);
 
         let onpointerup = (event) => {
-            incppect.send(EventType.MouseUp + event.button + ' ' + this.io.mouse_x + ' ' + this.io.mouse_y);
+            this.send_input(EventType.MouseUp, 'iff', event.button, this.io.mouse_x, this.io.mouse_y);
 
             if (this.io.want_capture_mouse) {
                 event.preventDefault();
@@ -159,7 +232,7 @@ var imgui_ws = {
             let wheel_x =  event.deltaX * scale;
             let wheel_y = -event.deltaY * scale;
 
-            incppect.send(EventType.MouseWheel + wheel_x + ' ' + wheel_y);
+            this.send_input(EventType.MouseWheel, 'ff', wheel_x, wheel_y);
 
             if (this.io.want_capture_mouse) {
                 event.preventDefault();
@@ -216,16 +289,16 @@ var imgui_ws = {
         });
         this.virtual_input.addEventListener('compositionend', () => {
             this.isComposing = false;
-            incppect.send(EventType.InputText + this.virtual_input.value);
+            this.send_input(EventType.InputText, 's', this.virtual_input.value);
             this.virtual_input.value = '';
         });
         this.virtual_input.addEventListener('input', (event) => {
             if (!this.isComposing) {
                 if (this.virtual_input.value === ' ') {
-                    incppect.send(EventType.KeyPress + spaceKey);
+                    this.send_input(EventType.KeyPress, 'i', spaceKey);
                 }
                 else {
-                    incppect.send(EventType.InputText + this.virtual_input.value);
+                    this.send_input(EventType.InputText, 's', this.virtual_input.value);
                 }
                 this.virtual_input.value = '';
             }
@@ -279,6 +352,12 @@ var imgui_ws = {
         this.attribute_location_position = this.gl.getAttribLocation(this.shader_program,    "Position");
         this.attribute_location_uv       = this.gl.getAttribLocation(this.shader_program,    "UV");
         this.attribute_location_color    = this.gl.getAttribLocation(this.shader_program,    "Color");
+
+        // faint gray until the pixels of a texture arrived
+        this.tex_placeholder = this.gl.createTexture();
+        this.gl.bindTexture(this.gl.TEXTURE_2D, this.tex_placeholder);
+        this.gl.texParameteri(this.gl.TEXTURE_2D, this.gl.TEXTURE_MIN_FILTER, this.gl.LINEAR);
+        this.gl.texImage2D(this.gl.TEXTURE_2D, 0, this.gl.RGBA, 1, 1, 0, this.gl.RGBA, this.gl.UNSIGNED_BYTE, new Uint8Array([128, 128, 128, 96]));
     },
 
     incppect_textures: function(incppect) {
@@ -286,86 +365,321 @@ var imgui_ws = {
 
         for (let i = 0; i < n_textures; ++i) {
             const tex_id = incppect.get_int32('imgui.texture_id[%d]', i);
-            if (tex_id !== undefined)
-            {
-                const tex_rev = incppect.get_int32('imgui.texture_revision[%d]', tex_id);
+            if (tex_id === undefined) {
+                continue;
+            }
+            const tex_rev = incppect.get_int32('imgui.texture_revision[%d]', tex_id);
+            if (tex_rev === undefined || (this.tex_map_id[tex_id] != null && this.tex_map_rev[tex_id] === tex_rev)) {
+                continue;
+            }
 
-                if (this.tex_map_abuf[tex_id] == null || this.tex_map_abuf[tex_id].byteLength < 1) {
-                    this.tex_map_abuf[tex_id] = incppect.get_abuf('imgui.texture_data[%d]', tex_id);
-                } else if (this.tex_map_abuf[tex_id] && (this.tex_map_id[tex_id] == null || this.tex_map_rev[tex_id] != tex_rev)) {
-                    this.tex_map_abuf[tex_id] = incppect.get_abuf('imgui.texture_data[%d]', tex_id);
-                    imgui_ws.init_tex(tex_id, tex_rev, this.tex_map_abuf[tex_id]);
+            // a texture we already hold only needs the tiles changed since our revision
+            if (this.tex_map_id[tex_id] != null && this.tex_map_rev[tex_id] < tex_rev) {
+                const patches_abuf = incppect.get_abuf('imgui.texture_patches[%d]', tex_id);
+                const result = imgui_ws.apply_tex_patches(tex_id, tex_rev, patches_abuf);
+                if (result !== 'full') {
+                    continue;
                 }
             }
+
+            // the browser is still decoding the payload we got
+            if (this.tex_map_decoding[tex_id] !== undefined) {
+                continue;
+            }
+
+            // the same pixels may be cached by an earlier session, the texture data is only requested on a miss
+            const tex_hash = this.tex_hash_str(incppect.get_abuf('imgui.texture_hash[%d]', tex_id));
+            if (tex_hash !== null) {
+                const cached = this.tex_cache_get(tex_hash);
+                if (cached === undefined) {
+                    continue;
+                }
+                if (cached !== null) {
+                    imgui_ws.init_tex(tex_id, tex_rev, cached, true);
+                    continue;
+                }
+            }
+
+            this.tex_map_abuf[tex_id] = incppect.get_abuf('imgui.texture_data[%d]', tex_id);
+            if (this.tex_map_abuf[tex_id].byteLength > 0) {
+                imgui_ws.init_tex(tex_id, tex_rev, this.tex_map_abuf[tex_id], false);
+            }
         }
     },
 
-    init_tex: function(tex_id, tex_rev, tex_abuf) {
-        const tex_abuf_uint8 = new Uint8Array(tex_abuf);
-        const tex_abuf_int32 = new Int32Array(tex_abuf);
+    // uint64 hash as hex, null when the texture isn't cacheable
+    tex_hash_str: function(abuf) {
+        if (abuf == null || abuf.byteLength < 8) {
+            return null;
+        }
+        const words = new Uint32Array(abuf, 0, 2);
+        if (words[0] === 0 && words[1] === 0) {
+            return null;
+        }
+        return words[1].toString(16).padStart(8, '0') + words[0].toString(16).padStart(8, '0');
+    },
 
-        const type = tex_abuf_int32[1];
-        const width = tex_abuf_int32[2];
-        const height = tex_abuf_int32[3];
-        const revision = tex_abuf_int32[4];
+    // texture payloads of earlier sessions by content hash, kept in IndexedDB
+    tex_cache_open: function() {
+        if (!window.indexedDB) {
+            this.tex_cache_db = false;
+            return;
+        }
+        const request = window.indexedDB.open('imgui-ws', 1);
+        request.onupgradeneeded = () => {
+            const store = request.result.createObjectStore('textures', { keyPath: 'hash' });
+            store.createIndex('time', 'time');
+        };
+        request.onsuccess = () => { this.tex_cache_db = request.result; };
+        request.onerror = () => { this.tex_cache_db = false; };
+    },
 
-        if (this.tex_map_rev[tex_id] && revision === this.tex_map_rev[tex_id]) {
+    // the cached payload, null on a miss, undefined while the lookup is running
+    tex_cache_get: function(hash) {
+        if (this.tex_cache_db === false) {
+            return null;
+        }
+        if (this.tex_cache_db === null || hash in this.tex_cache_lookups) {
+            return this.tex_cache_lookups[hash];
+        }
+        this.tex_cache_lookups[hash] = undefined;
+        try {
+            const store = this.tex_cache_db.transaction('textures', 'readwrite').objectStore('textures');
+            const request = store.get(hash);
+            request.onsuccess = () => {
+                const entry = request.result;
+                this.tex_cache_lookups[hash] = entry ? entry.data : null;
+                if (entry) {
+                    // least recently used entries are evicted first
+                    entry.time = Date.now();
+                    store.put(entry);
+                }
+            };
+            request.onerror = () => { this.tex_cache_lookups[hash] = null; };
+        } catch (err) {
+            this.tex_cache_lookups[hash] = null;
+        }
+        return undefined;
+    },
+
+    tex_cache_put: function(hash, abuf) {
+        if (!this.tex_cache_db) {
             return;
         }
+        try {
+            const store = this.tex_cache_db.transaction('textures', 'readwrite').objectStore('textures');
+            store.put({ hash: hash, data: abuf, time: Date.now() });
+            const count = store.count();
+            count.onsuccess = () => {
+                let excess = count.result - this.k_tex_cache_max_entries;
+                if (excess <= 0) {
+                    return;
+                }
+                store.index('time').openCursor().onsuccess = (evt) => {
+                    const cursor = evt.target.result;
+                    if (cursor && excess > 0) {
+                        excess -= 1;
+                        cursor.delete();
+                        cursor.continue();
+                    }
+                };
+            };
+        } catch (err) {
+            console.error('failed to cache texture %s: %s', hash, err);
+        }
+    },
+
+    remove_tex: function(tex_id) {
+        if (this.tex_map_id[tex_id]) {
+            this.gl.deleteTexture(this.tex_map_id[tex_id]);
+        }
+        delete this.tex_map_id[tex_id];
+        delete this.tex_map_rev[tex_id];
+        delete this.tex_map_abuf[tex_id];
+        delete this.tex_map_type[tex_id];
+        delete this.tex_map_decoding[tex_id];
+        // drop the pixels incppect still holds for the texture, the paths stay registered
+        for (const path of ['imgui.texture_data[' + tex_id + ']', 'imgui.texture_patches[' + tex_id + ']']) {
+            if (path in incppect.vars_map) {
+                incppect.vars_map[path] = new ArrayBuffer();
+            }
+        }
+    },
 
-        const pixels = new Uint8Array(4 * width * height);
+    // rgba pixels of the texture types: 0 Alpha8, 1 Gray8, 2 RGB24, 3 RGBA32
+    tex_to_rgba: function(type, src, offset, n) {
+        const pixels = new Uint8Array(4 * n);
 
         if (type === 0) { // Alpha8
-            for (let i = 0; i < width*height; ++i) {
+            for (let i = 0; i < n; ++i) {
                 pixels[4*i + 0] = 0xFF;
                 pixels[4*i + 1] = 0xFF;
                 pixels[4*i + 2] = 0xFF;
-                pixels[4*i + 3] = tex_abuf_uint8[20 + i];
+                pixels[4*i + 3] = src[offset + i];
             }
         } else if (type === 1) { // Gray8
-            for (let i = 0; i < width*height; ++i) {
-                pixels[4*i + 0] = tex_abuf_uint8[20 + i];
-                pixels[4*i + 1] = tex_abuf_uint8[20 + i];
-                pixels[4*i + 2] = tex_abuf_uint8[20 + i];
+            for (let i = 0; i < n; ++i) {
+                pixels[4*i + 0] = src[offset + i];
+                pixels[4*i + 1] = src[offset + i];
+                pixels[4*i + 2] = src[offset + i];
                 pixels[4*i + 3] = 0xFF;
             }
         } else if (type === 2) { // RGB24
-            for (let i = 0; i < width*height; ++i) {
-                pixels[4*i + 0] = tex_abuf_uint8[20 + 3*i + 0];
-                pixels[4*i + 1] = tex_abuf_uint8[20 + 3*i + 1];
-                pixels[4*i + 2] = tex_abuf_uint8[20 + 3*i + 2];
+            for (let i = 0; i < n; ++i) {
+                pixels[4*i + 0] = src[offset + 3*i + 0];
+                pixels[4*i + 1] = src[offset + 3*i + 1];
+                pixels[4*i + 2] = src[offset + 3*i + 2];
                 pixels[4*i + 3] = 0xFF;
             }
         } else if (type === 3) { // RGBA32
-            for (let i = 0; i < width*height; ++i) {
-                pixels[4*i + 0] = tex_abuf_uint8[20 + 4*i + 0];
-                pixels[4*i + 1] = tex_abuf_uint8[20 + 4*i + 1];
-                pixels[4*i + 2] = tex_abuf_uint8[20 + 4*i + 2];
-                pixels[4*i + 3] = tex_abuf_uint8[20 + 4*i + 3];
+            pixels.set(src.subarray(offset, offset + 4*n));
+        }
+
+        return pixels;
+    },
+
+    // patches: [id][revision][n patches] patch: [base revision][revision][n tiles] tile: [x][y][w][h][pixels padded to 4]
+    // returns 'applied', 'pending' while the patches of tex_rev haven't arrived, or 'full' when they don't start at our revision
+    apply_tex_patches: function(tex_id, tex_rev, patches_abuf) {
+        if (patches_abuf == null || patches_abuf.byteLength < 12) {
+            return 'pending';
+        }
+        const header = new Int32Array(patches_abuf, 0, 3);
+        if (header[0] !== tex_id || header[1] < tex_rev) {
+            return 'pending';
+        }
+
+        const type = this.tex_map_type[tex_id];
+        const bpp = type === 2 ? 3 : (type === 3 ? 4 : 1);
+        const n_patches = header[2];
+        const src = new Uint8Array(patches_abuf);
+
+        // find the patch starting at our revision, later ones follow in order
+        let offset = 12;
+        let first = -1;
+        const patch_offsets = [];
+        for (let p = 0; p < n_patches; ++p) {
+            const patch = new Int32Array(patches_abuf, offset, 3);
+            patch_offsets.push(offset);
+            if (patch[0] === this.tex_map_rev[tex_id]) {
+                first = p;
+            }
+            offset += 12;
+            for (let t = 0; t < patch[2]; ++t) {
+                const tile = new Int32Array(patches_abuf, offset, 4);
+                offset += 16 + Math.ceil(tile[2] * tile[3] * bpp / 4) * 4;
             }
         }
+        if (first < 0) {
+            return 'full';
+        }
+
+        this.gl.bindTexture(this.gl.TEXTURE_2D, this.tex_map_id[tex_id]);
+        for (let p = first; p < n_patches; ++p) {
+            offset = patch_offsets[p];
+            const patch = new Int32Array(patches_abuf, offset, 3);
+            offset += 12;
+            for (let t = 0; t < patch[2]; ++t) {
+                const tile = new Int32Array(patches_abuf, offset, 4);
+                offset += 16;
+                const pixels = this.tex_to_rgba(type, src, offset, tile[2] * tile[3]);
+                this.gl.texSubImage2D(this.gl.TEXTURE_2D, 0, tile[0], tile[1], tile[2], tile[3], this.gl.RGBA, this.gl.UNSIGNED_BYTE, pixels);
+                offset += Math.ceil(tile[2] * tile[3] * bpp / 4) * 4;
+            }
+            this.tex_map_rev[tex_id] = patch[1];
+        }
+
+        return 'applied';
+    },
 
-        this.tex_map_rev[tex_id] = tex_rev;
+    // header: [id][type][width][height][revision][uint64 hash][codec][payload size], the payload follows
+    // a cached payload has the revision of an earlier session, it stands for the current revision tex_rev
+    init_tex: function(tex_id, tex_rev, tex_abuf, from_cache) {
+        const header = new Int32Array(tex_abuf, 0, 9);
+
+        const type = header[1];
+        const width = header[2];
+        const height = header[3];
+        const revision = from_cache ? tex_rev : header[4];
+        const hash = this.tex_hash_str(tex_abuf.slice(20, 28));
+        const codec = header[7];
+        const payload_size = header[8];
+
+        if (this.tex_map_rev[tex_id] && revision === this.tex_map_rev[tex_id]) {
+            return;
+        }
+
+        if (hash !== null) {
+            if (from_cache) {
+                delete this.tex_cache_lookups[hash];
+            } else {
+                this.tex_cache_put(hash, tex_abuf);
+            }
+        }
+
+        if (codec === TextureCodec.Raw) {
+            const pixels = this.tex_to_rgba(type, new Uint8Array(tex_abuf), 36, width * height);
+            this.upload_tex(tex_id, revision, type, () => {
+                this.gl.texImage2D(this.gl.TEXTURE_2D, 0, this.gl.RGBA, width, height, 0, this.gl.RGBA, this.gl.UNSIGNED_BYTE, pixels);
+            });
+            return;
+        }
+
+        // png or jpeg already holding rgba, decoded off the main thread by the browser
+        if (this.tex_map_decoding[tex_id] === revision) {
+            return;
+        }
+        this.tex_map_decoding[tex_id] = revision;
+        const blob = new Blob([new Uint8Array(tex_abuf, 36, payload_size)], { type: codec === TextureCodec.PNG ? 'image/png' : 'image/jpeg' });
+        createImageBitmap(blob, { premultiplyAlpha: 'none', colorSpaceConversion: 'none' }).then((bitmap) => {
+            // removed or superseded by a newer revision meanwhile
+            if (this.tex_map_decoding[tex_id] === revision) {
+                delete this.tex_map_decoding[tex_id];
+                if (!(this.tex_map_rev[tex_id] >= revision)) {
+                    this.upload_tex(tex_id, revision, type, () => {
+                        this.gl.texImage2D(this.gl.TEXTURE_2D, 0, this.gl.RGBA, this.gl.RGBA, this.gl.UNSIGNED_BYTE, bitmap);
+                    });
+                }
+            }
+            bitmap.close();
+        }).catch((err) => {
+            console.error('failed to decode texture %d: %s', tex_id, err);
+            delete this.tex_map_decoding[tex_id];
+        });
+    },
+
+    upload_tex: function(tex_id, revision, type, upload) {
+        this.tex_map_rev[tex_id] = revision;
+        this.tex_map_type[tex_id] = type;
 
         if (this.tex_map_id[tex_id]) {
             this.gl.bindTexture(this.gl.TEXTURE_2D, this.tex_map_id[tex_id]);
-            this.gl.texImage2D(this.gl.TEXTURE_2D, 0, this.gl.RGBA, width, height, 0, this.gl.RGBA, this.gl.UNSIGNED_BYTE, pixels);
         } else {
             this.tex_map_id[tex_id] = this.gl.createTexture();
             this.gl.bindTexture(this.gl.TEXTURE_2D, this.tex_map_id[tex_id]);
             this.gl.texParameteri(this.gl.TEXTURE_2D, this.gl.TEXTURE_MIN_FILTER, this.gl.LINEAR);
             this.gl.texParameteri(this.gl.TEXTURE_2D, this.gl.TEXTURE_MAG_FILTER, this.gl.LINEAR);
             //this.gl.pixelStorei(gl.UNPACK_ROW_LENGTH); // WebGL2
-            this.gl.texImage2D(this.gl.TEXTURE_2D, 0, this.gl.RGBA, width, height, 0, this.gl.RGBA, this.gl.UNSIGNED_BYTE, pixels);
         }
+        upload();
     },
 
     incppect_draw_lists: function(incppect) {
         this.n_draw_lists = incppect.get_int32('imgui.n_draw_lists');
         if (this.n_draw_lists < 1) return;
 
+        const now_ms = incppect.timestamp();
         for (let i = 0; i < this.n_draw_lists; ++i) {
-            this.draw_lists_abuf[i] = incppect.get_abuf('imgui.draw_list[%d]', i);
+            // the first uint32 of a draw list payload is its revision, unchanged draw lists are not requested
+            const rev = incppect.get_uint32('imgui.draw_list_revision[%d]', i);
+            const abuf = this.draw_lists_abuf[i];
+            const cur_rev = (abuf && abuf.byteLength >= 4) ? (new Uint32Array(abuf, 0, 1))[0] : undefined;
+            if (rev === undefined || cur_rev !== rev) {
+                this.draw_lists_changed_ms[i] = now_ms;
+            }
+            if (now_ms - this.draw_lists_changed_ms[i] < this.k_draw_list_hot_ms) {
+                this.draw_lists_abuf[i] = incppect.get_abuf('imgui.draw_list[%d]', i);
+            }
         }
     },
 
@@ -424,9 +738,10 @@ var imgui_ws = {
         this.gl.enable(this.gl.SCISSOR_TEST);
 
         for (let i_list = 0; i_list < n_draw_lists; ++i_list) {
-            if (draw_lists_abuf[i_list].byteLength < 1) continue;
+            if (draw_lists_abuf[i_list].byteLength < 4) continue;
 
-            let draw_data_offset = 0;
+            // skip revision
+            let draw_data_offset = 4;
 
             let p = new Float32Array(draw_lists_abuf[i_list], draw_data_offset, 2);
             const offset_x = p[0];
@@ -482,10 +797,8 @@ var imgui_ws = {
 
                 if (clip_x < this.canvas.width && clip_y < this.canvas.height && clip_z >= 0.0 && clip_w >= 0.0) {
                     this.gl.scissor(clip_x, this.canvas.height - clip_w, clip_z - clip_x, clip_w - clip_y);
-                    if (texture_id in this.tex_map_id) {
-                        this.gl.activeTexture(this.gl.TEXTURE0);
-                        this.gl.bindTexture(this.gl.TEXTURE_2D, this.tex_map_id[texture_id]);
-                    }
+                    this.gl.activeTexture(this.gl.TEXTURE0);
+                    this.gl.bindTexture(this.gl.TEXTURE_2D, texture_id in this.tex_map_id ? this.tex_map_id[texture_id] : this.tex_placeholder);
                     this.gl.drawElements(this.gl.TRIANGLES, n_elements, this.gl.UNSIGNED_INT, 4*offset_idx);
                 }
             }
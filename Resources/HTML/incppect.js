@@ -11,6 +11,8 @@
     var_to_id: {},
     id_to_var: {},
     last_data: null,
+    // streamed vars being assembled, by var id: { buffer, received }
+    streams: {},
 
     // requests data
     requests: [],
@@ -27,6 +29,8 @@
     k_var_delim: ' ',
     k_auto_reconnect: true,
     k_requests_update_freq_ms: 50,
+    // binary var registration and input events, false falls back to the legacy text format
+    k_binary_protocol: true,
 
     // stats
     stats: {
@@ -232,7 +236,24 @@
         this.stats.tx_bytes += data.length;
     },
 
+    // custom message with a binary payload
+    send_abuf: function(payload) {
+        const data = new Uint8Array(8 + payload.byteLength);
+        this.set_data_num(data, data.length - 4);
+        data[4] = 4;
+        data.set(payload, 8);
+        this.ws.send(data);
+
+        this.stats.tx_n += 1;
+        this.stats.tx_bytes += data.length;
+    },
+
     send_var_to_id_map: function() {
+        if (this.k_binary_protocol) {
+            this.send_var_to_id_map_binary();
+            return;
+        }
+
         let msg = '';
         const delim = this.k_var_delim;
         for (const key in this.var_to_id) {
@@ -257,6 +278,47 @@
         this.stats.tx_bytes += data.length;
     },
 
+    // [size][5][uint8 version][3 bytes padding] then per var:
+    // [int32 request id][uint16 path size][uint16 idxs num][utf8 path][padding to 4 bytes][int32 idx...]
+    send_var_to_id_map_binary: function() {
+        const enc = new TextEncoder();
+        const entries = [];
+        let size = 12;
+        for (const key in this.var_to_id) {
+            const idxs = [];
+            const keyp = key.replace(/\[-?\d*\]/g, function (m) {
+                idxs.push(parseInt(m.replace(/[\[\]]/g, '')) || 0);
+                return '[%d]';
+            });
+            const path = enc.encode(keyp);
+            entries.push({ id: this.var_to_id[key], path: path, idxs: idxs });
+            size += 8 + ((path.length + 3) & ~3) + 4*idxs.length;
+        }
+
+        const data = new ArrayBuffer(size);
+        const view = new DataView(data);
+        const bytes = new Uint8Array(data);
+        view.setInt32(0, size - 4, true);
+        view.setInt32(4, 5, true);
+        view.setUint8(8, 1);
+        let offset = 12;
+        for (const entry of entries) {
+            view.setInt32(offset, entry.id, true);
+            view.setUint16(offset + 4, entry.path.length, true);
+            view.setUint16(offset + 6, entry.idxs.length, true);
+            bytes.set(entry.path, offset + 8);
+            offset += 8 + ((entry.path.length + 3) & ~3);
+            for (const idx of entry.idxs) {
+                view.setInt32(offset, idx, true);
+                offset += 4;
+            }
+        }
+        this.ws.send(data);
+
+        this.stats.tx_n += 1;
+        this.stats.tx_bytes += size;
+    },
+
     send_requests: function() {
         let same = true;
         if (this.requests_old === null || this.requests.length !== this.requests_old.length){
@@ -298,21 +360,75 @@
         this.vars_map = {};
         this.var_to_id = {};
         this.id_to_var = {};
+        this.streams = {};
         this.requests = null;
         this.requests_old = null;
         this.ws = null;
     },
 
+    // decode a raw lz4 block, returns the number of bytes written to dst
+    lz4_decompress: function(src, dst) {
+        let si = 0;
+        let di = 0;
+        while (si < src.length) {
+            const token = src[si++];
+
+            let nlit = token >> 4;
+            if (nlit === 15) {
+                let b = 0;
+                do { b = src[si++]; nlit += b; } while (b === 255);
+            }
+            dst.set(src.subarray(si, si + nlit), di);
+            si += nlit;
+            di += nlit;
+            if (si >= src.length) {
+                break;
+            }
+
+            const offset = src[si] | (src[si + 1] << 8);
+            si += 2;
+
+            let nmatch = token & 15;
+            if (nmatch === 15) {
+                let b = 0;
+                do { b = src[si++]; nmatch += b; } while (b === 255);
+            }
+            nmatch += 4;
+
+            // the match may overlap the output, copy byte by byte
+            let ref = di - offset;
+            for (let i = 0; i < nmatch; ++i) {
+                dst[di++] = dst[ref++];
+            }
+        }
+        return di;
+    },
+
     onmessage: function(evt) {
         this.stats.rx_n += 1;
         this.stats.rx_bytes += evt.data.byteLength;
 
-        const type_all = (new Uint32Array(evt.data))[0];
+        let data = evt.data;
+        let type_all = (new Uint32Array(data, 0, 1))[0];
+
+        if (type_all === 2) {
+            // lz4 frame: [2][uncompressed size][compressed size][lz4 block]
+            const header = new Uint32Array(data, 0, 3);
+            const raw = new ArrayBuffer(header[1]);
+            this.lz4_decompress(new Uint8Array(data, 12, header[2]), new Uint8Array(raw));
+            data = raw;
+            type_all = (new Uint32Array(data, 0, 1))[0];
+        }
+
+        if (type_all === 3) {
+            this.on_stream_chunk(data);
+            return;
+        }
 
         if (this.last_data != null && type_all === 1) {
-            const ntotal = evt.data.byteLength / 4 - 1;
+            const ntotal = data.byteLength / 4 - 1;
 
-            const src_view = new Uint32Array(evt.data, 4);
+            const src_view = new Uint32Array(data, 4);
             const dst_view = new Uint32Array(this.last_data, 4);
 
             let k = 0;
@@ -325,7 +441,7 @@
                 }
             }
         } else {
-            this.last_data = evt.data;
+            this.last_data = data;
         }
 
         const int_view = new Uint32Array(this.last_data);
@@ -372,6 +488,35 @@
         }
     },
 
+    // chunk of a streamed var: [3][var id][total size][offset][chunk size][chunk]
+    // the var keeps its previous value until the last chunk arrived
+    on_stream_chunk: function(data) {
+        const header = new Uint32Array(data, 0, 5);
+        const id = header[1];
+        const total_size = header[2];
+        const offset = header[3];
+        const chunk_size = header[4];
+
+        let stream = this.streams[id];
+        if (offset === 0 || stream == null || stream.buffer.byteLength !== Math.ceil(total_size / 4) * 4) {
+            // padded like the full updates, so the value can be viewed as 32 bit words
+            stream = { buffer: new ArrayBuffer(Math.ceil(total_size / 4) * 4), received: 0 };
+            this.streams[id] = stream;
+        }
+        if (offset !== stream.received) {
+            // a chunk went missing, wait for the server to restart the stream
+            delete this.streams[id];
+            return;
+        }
+        new Uint8Array(stream.buffer).set(new Uint8Array(data, 20, chunk_size), offset);
+        stream.received += chunk_size;
+
+        if (stream.received >= total_size) {
+            this.vars_map[this.id_to_var[id]] = stream.buffer;
+            delete this.streams[id];
+        }
+    },
+
     onerror: function(evt) {
         console.error("[incppect]", evt);
     },
@@ -7,5 +7,6 @@ FImGuiDelegates::FOnImGuiContextDestroyed FImGuiDelegates::OnImGuiContextDestroy
 
 FImGuiDelegates::FOnImGui_WS_Enable FImGuiDelegates::OnImGui_WS_Enable;
 FImGuiDelegates::FOnImGui_WS_Disable FImGuiDelegates::OnImGui_WS_Disable;
+FImGuiDelegates::FOnImGui_WS_WakeUp FImGuiDelegates::OnImGui_WS_WakeUp;
 FImGuiDelegates::FOnImGuiLocalPanelEnable FImGuiDelegates::OnImGuiLocalPanelEnable;
 FImGuiDelegates::FOnImGuiLocalPanelDisable FImGuiDelegates::OnImGuiLocalPanelDisable;
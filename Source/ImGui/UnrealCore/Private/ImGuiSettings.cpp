@@ -29,6 +29,9 @@ UImGuiSettings::UImGuiSettings()
 	SectionName = TEXT("ImGui_WS_Settings");
 
 	PreUserSettings = GetMutableDefault<UImGuiPerUserSettings>();
+
+	// packaged server is usually accessed remotely
+	ServerCompression.bPerMessageDeflate = true;
 }
 
 #if WITH_EDITOR
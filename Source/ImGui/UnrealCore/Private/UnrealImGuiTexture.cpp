@@ -6,13 +6,30 @@
 #include "ImageUtils.h"
 #include "imgui.h"
 #include "RenderingThread.h"
+#include "RHIGPUReadback.h"
 #include "TextureResource.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Containers/Ticker.h"
 #include "Engine/Texture2D.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/List.h"
+#include "Misc/App.h"
+#include <atomic>
+#include <limits>
 
 namespace UnrealImGui
 {
 	Private::FUpdateTextureData_WS Private::UpdateTextureData_WS;
+	Private::FRemoveTextureData_WS Private::RemoveTextureData_WS;
+
+	TAutoConsoleVariable<int32> CVar_TextureBudgetMB
+	{
+		TEXT("ImGui.TextureBudgetMB"),
+		256,
+		TEXT("Size of the textures sent to remote clients, least recently drawn textures of FindOrAddTexture are released above it, 0 disables it"),
+	};
 
 	namespace TextureIdManager
 	{
@@ -20,6 +37,28 @@ namespace UnrealImGui
 		uint32 HandleIdCounter = 0;
 		TMap<TWeakObjectPtr<const UTexture>, uint32> HandleIdMap;
 		TMap<uint32, TWeakObjectPtr<const UTexture>> IdTextureMap;
+
+		// uploaded or referenced textures
+		struct FTextureEntry
+		{
+			int32 RefCount = 0;
+			int64 Bytes = 0;
+			uint64 LastUsedFrame = 0;
+			// only textures created by FindOrAddTexture, they are recreated on their next use
+			// handles the caller keeps are never evicted, they would draw the placeholder until released
+			bool bEvictable = false;
+			// unreferenced evictable textures, while uploaded
+			TDoubleLinkedList<uint32>::TDoubleLinkedListNode* LruNode = nullptr;
+		};
+		TMap<uint32, FTextureEntry> Entries;
+		// evictable textures, most recently used first
+		TDoubleLinkedList<uint32> LruList;
+		int64 TotalBytes = 0;
+
+		void Touch(uint32 Id);
+		void SetEvictable(uint32 Id, bool bEvictable);
+		void OnUploaded(uint32 Id, int64 Bytes);
+		void Remove(uint32 Id);
 	}
 
 	UTextureRenderTarget2D* CreateTexture(FImGuiTextureHandle& Handle, ETextureFormat TextureFormat, int32 Width, int32 Height, UObject* Outer, const FName& Name)
@@ -40,7 +79,9 @@ namespace UnrealImGui
 	{
 		if (Private::UpdateTextureData_WS)
 		{
+			const int32 BytesPerPixel = TextureFormat == ETextureFormat::RGBA8 ? 4 : TextureFormat == ETextureFormat::RGB8 ? 3 : 1;
 			Private::UpdateTextureData_WS(Handle, TextureFormat, Width, Height, Data);
+			TextureIdManager::OnUploaded(Handle, (int64)Width * Height * BytesPerPixel);
 		}
 	}
 
@@ -138,275 +179,285 @@ namespace UnrealImGui
 		}
 	}
 
-	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTexture2D* Texture2D)
+	namespace PixelConversion
 	{
-		if (Texture2D == nullptr)
+		// below this size the ParallelFor overhead outweighs the conversion
+		constexpr int64 ParallelMinPixels = 256 * 256;
+		constexpr int64 BlockPixels = 32 * 1024;
+
+		int32 GetBytesPerPixel(ETextureFormat TextureFormat)
 		{
-			return;
+			switch (TextureFormat)
+			{
+			case ETextureFormat::RGB8:
+				return 3;
+			case ETextureFormat::RGBA8:
+				return 4;
+			default:
+				return 1;
+			}
 		}
-		FImage Image;
-		if (FImageUtils::GetTexture2DSourceImage(Texture2D, Image) == false)
+
+		// Kernel(Begin, End) converts a range of pixels, large images are split in blocks across the task graph
+		template<typename TKernel>
+		void Convert(int64 NumPixels, const TKernel& Kernel)
 		{
-			return;
+			if (NumPixels < ParallelMinPixels)
+			{
+				Kernel(0, NumPixels);
+				return;
+			}
+			const int32 NumBlocks = (int32)((NumPixels + BlockPixels - 1) / BlockPixels);
+			ParallelFor(NumBlocks, [&](int32 BlockIdx)
+			{
+				const int64 Begin = BlockIdx * BlockPixels;
+				Kernel(Begin, FMath::Min(Begin + BlockPixels, NumPixels));
+			});
 		}
-		switch (Image.Format) {
-		case ERawImageFormat::G8:
-			UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Image.AsG8().GetData());
-			break;
-		case ERawImageFormat::BGRA8:
-		case ERawImageFormat::BGRE8:
-			switch (TextureFormat)
+
+		// scaled to [0, 255] before the truncating store, HDR values don't rely on the store saturating
+		FORCEINLINE VectorRegister4Float Saturate255(const VectorRegister4Float& Color)
+		{
+			const VectorRegister4Float Max = VectorSetFloat1(255.f);
+			return VectorMin(VectorMax(VectorMultiply(Color, Max), VectorZeroFloat()), Max);
+		}
+
+		// rgba floats to 1, 3 or 4 bytes, saturated and truncated like the scalar cast, single channel formats keep the alpha
+		template<int32 BytesPerPixel>
+		FORCEINLINE void StoreFloat4(const VectorRegister4Float& Color, uint8* Dst)
+		{
+			uint8 Bytes[4];
+			VectorStoreByte4(Saturate255(Color), Bytes);
+			if constexpr (BytesPerPixel == 1)
 			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
+				Dst[0] = Bytes[3];
+			}
+			else
+			{
+				FMemory::Memcpy(Dst, Bytes, BytesPerPixel);
+			}
+		}
+
+		template<int32 BytesPerPixel, typename TLoad>
+		void ConvertFloat4(int64 NumPixels, uint8* Dst, const TLoad& Load)
+		{
+			Convert(NumPixels, [&](int64 Begin, int64 End)
+			{
+				for (int64 Idx = Begin; Idx < End; ++Idx)
 				{
-					const TArrayView64<FColor> RawData = Image.Format == ERawImageFormat::BGRA8 ? Image.AsBGRA8() : Image.AsBGRE8();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx] = RawData[Idx].A;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					StoreFloat4<BytesPerPixel>(Load(Idx), Dst + Idx * BytesPerPixel);
 				}
+			});
+		}
+
+		template<typename TLoad>
+		void ConvertFloat4(ETextureFormat TextureFormat, int64 NumPixels, uint8* Dst, const TLoad& Load)
+		{
+			switch (GetBytesPerPixel(TextureFormat))
+			{
+			case 1:
+				ConvertFloat4<1>(NumPixels, Dst, Load);
 				break;
-			case ETextureFormat::RGB8:
+			case 3:
+				ConvertFloat4<3>(NumPixels, Dst, Load);
+				break;
+			default:
+				ConvertFloat4<4>(NumPixels, Dst, Load);
+				break;
+			}
+		}
+
+		// single channel floats, four pixels per vector
+		template<typename TLoad4, typename TLoad1>
+		void ConvertFloat1(int64 NumPixels, uint8* Dst, const TLoad4& Load4, const TLoad1& Load1)
+		{
+			Convert(NumPixels, [&](int64 Begin, int64 End)
+			{
+				int64 Idx = Begin;
+				for (; Idx + 4 <= End; Idx += 4)
 				{
-					const TArrayView64<FColor> RawData = Image.Format == ERawImageFormat::BGRA8 ? Image.AsBGRA8() : Image.AsBGRE8();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 3] = RawData[Idx].R;
-						Data[Idx * 3 + 1] = RawData[Idx].G;
-						Data[Idx * 3 + 2] = RawData[Idx].B;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					VectorStoreByte4(Saturate255(Load4(Idx)), Dst + Idx);
 				}
-				break;
-			case ETextureFormat::RGBA8:
+				for (; Idx < End; ++Idx)
 				{
-					const TArrayView64<FColor> RawData = Image.Format == ERawImageFormat::BGRA8 ? Image.AsBGRA8() : Image.AsBGRE8();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 4] = RawData[Idx].R;
-						Data[Idx * 4 + 1] = RawData[Idx].G;
-						Data[Idx * 4 + 2] = RawData[Idx].B;
-						Data[Idx * 4 + 3] = RawData[Idx].A;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					Dst[Idx] = (uint8)FMath::Clamp(Load1(Idx) * 255.f, 0.f, 255.f);
 				}
-				break;
-			}
-			break;
-		case ERawImageFormat::RGBA16:
+			});
+		}
+
+		void ConvertBGRA8(ETextureFormat TextureFormat, const FColor* Src, int64 NumPixels, uint8* Dst)
+		{
 			switch (TextureFormat)
 			{
 			case ETextureFormat::Alpha8:
 			case ETextureFormat::Gray8:
+				Convert(NumPixels, [&](int64 Begin, int64 End)
 				{
-					constexpr float RGBA16Scale = (float)TNumericLimits<uint8>::Max() / TNumericLimits<uint16>::Max();
-					const TArrayView64<uint16> RawData = Image.AsRGBA16();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
+					for (int64 Idx = Begin; Idx < End; ++Idx)
 					{
-						Data[Idx] = RawData[Idx * 4 + 3] * RGBA16Scale;
+						Dst[Idx] = Src[Idx].A;
 					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
-				}
+				});
 				break;
 			case ETextureFormat::RGB8:
+				Convert(NumPixels, [&](int64 Begin, int64 End)
 				{
-					constexpr float RGBA16Scale = (float)TNumericLimits<uint8>::Max() / TNumericLimits<uint16>::Max();
-					const TArrayView64<uint16> RawData = Image.AsRGBA16();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < Image.GetWidth() * Image.GetHeight(); ++Idx)
+					for (int64 Idx = Begin; Idx < End; ++Idx)
 					{
-						Data[Idx * 3] = RawData[Idx * 4] * RGBA16Scale;
-						Data[Idx * 3 + 1] = RawData[Idx * 4 + 1] * RGBA16Scale;
-						Data[Idx * 3 + 2] = RawData[Idx * 4 + 2] * RGBA16Scale;
+						Dst[Idx * 3] = Src[Idx].R;
+						Dst[Idx * 3 + 1] = Src[Idx].G;
+						Dst[Idx * 3 + 2] = Src[Idx].B;
 					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
-				}
+				});
 				break;
 			case ETextureFormat::RGBA8:
+				// swapping the R and B bytes of each word, the compiler vectorizes this loop
+				Convert(NumPixels, [&](int64 Begin, int64 End)
 				{
-					constexpr float RGBA16Scale = (float)TNumericLimits<uint8>::Max() / TNumericLimits<uint16>::Max();
-					const TArrayView64<uint16> RawData = Image.AsRGBA16();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < Image.GetWidth() * Image.GetHeight(); ++Idx)
+					const uint32* SrcWords = reinterpret_cast<const uint32*>(Src);
+					uint32* DstWords = reinterpret_cast<uint32*>(Dst);
+					for (int64 Idx = Begin; Idx < End; ++Idx)
 					{
-						Data[Idx * 4] = RawData[Idx * 4] * RGBA16Scale;
-						Data[Idx * 4 + 1] = RawData[Idx * 4 + 1] * RGBA16Scale;
-						Data[Idx * 4 + 2] = RawData[Idx * 4 + 2] * RGBA16Scale;
-						Data[Idx * 4 + 3] = RawData[Idx * 4 + 3] * RGBA16Scale;
+						const uint32 Word = SrcWords[Idx];
+						DstWords[Idx] = (Word & 0xFF00FF00) | ((Word >> 16) & 0xFF) | ((Word & 0xFF) << 16);
 					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
-				}
+				});
 				break;
 			}
-			break;
-		case ERawImageFormat::RGBA16F:
-			switch (TextureFormat)
+		}
+
+		// V * 255 / 65535 == V / 257, the integer division gives the same bytes as the previous float scaling
+		void ConvertRGBA16(ETextureFormat TextureFormat, const uint16* Src, int64 NumPixels, uint8* Dst)
+		{
+			const int32 BytesPerPixel = GetBytesPerPixel(TextureFormat);
+			const int32 FirstChannel = BytesPerPixel == 1 ? 3 : 0;
+			Convert(NumPixels, [&](int64 Begin, int64 End)
 			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
+				for (int64 Idx = Begin; Idx < End; ++Idx)
 				{
-					const TArrayView64<FFloat16Color> RawData = Image.AsRGBA16F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
+					for (int32 Channel = 0; Channel < BytesPerPixel; ++Channel)
 					{
-						Data[Idx] = RawData[Idx].A * TNumericLimits<uint8>::Max();
+						Dst[Idx * BytesPerPixel + Channel] = Src[Idx * 4 + FirstChannel + Channel] / 257;
 					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
 				}
-				break;
-			case ETextureFormat::RGB8:
+			});
+		}
+
+		void ConvertG16(const uint16* Src, int64 NumPixels, uint8* Dst)
+		{
+			Convert(NumPixels, [&](int64 Begin, int64 End)
+			{
+				for (int64 Idx = Begin; Idx < End; ++Idx)
 				{
-					const TArrayView64<FFloat16Color> RawData = Image.AsRGBA16F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 3] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					Dst[Idx] = Src[Idx] / 257;
 				}
+			});
+		}
+		// converts the pixels of a source image to TextureFormat, Dst holds NumPixels * GetBytesPerPixel(TextureFormat) bytes
+		// single channel sources always write one byte per pixel, G8 needs no conversion and returns false like unsupported formats
+		bool ConvertImage(ERawImageFormat::Type SrcFormat, const uint8* SrcData, int64 NumPixels, ETextureFormat TextureFormat, uint8* Dst)
+		{
+			switch (SrcFormat)
+			{
+			case ERawImageFormat::BGRA8:
+			case ERawImageFormat::BGRE8:
+				ConvertBGRA8(TextureFormat, reinterpret_cast<const FColor*>(SrcData), NumPixels, Dst);
 				break;
-			case ETextureFormat::RGBA8:
+			case ERawImageFormat::RGBA16:
+				ConvertRGBA16(TextureFormat, reinterpret_cast<const uint16*>(SrcData), NumPixels, Dst);
+				break;
+			case ERawImageFormat::RGBA16F:
 				{
-					const TArrayView64<FFloat16Color> RawData = Image.AsRGBA16F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
+					const FFloat16Color* Src = reinterpret_cast<const FFloat16Color*>(SrcData);
+					ConvertFloat4(TextureFormat, NumPixels, Dst, [Src](int64 Idx)
 					{
-						Data[Idx * 4] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 3] = RawData[Idx].A * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+						float Color[4];
+						FPlatformMath::VectorLoadHalf(Color, reinterpret_cast<const uint16*>(Src + Idx));
+						return VectorLoad(Color);
+					});
 				}
 				break;
-			}
-			break;
-		case ERawImageFormat::RGBA32F:
-			switch (TextureFormat)
-			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
+			case ERawImageFormat::RGBA32F:
 				{
-					const TArrayView64<FLinearColor> RawData = Image.AsRGBA32F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
+					const FLinearColor* Src = reinterpret_cast<const FLinearColor*>(SrcData);
+					ConvertFloat4(TextureFormat, NumPixels, Dst, [Src](int64 Idx)
 					{
-						Data[Idx] = RawData[Idx].A * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+						return VectorLoad(&Src[Idx].R);
+					});
 				}
 				break;
-			case ETextureFormat::RGB8:
+			case ERawImageFormat::G16:
+				ConvertG16(reinterpret_cast<const uint16*>(SrcData), NumPixels, Dst);
+				break;
+			case ERawImageFormat::R16F:
 				{
-					const TArrayView64<FLinearColor> RawData = Image.AsRGBA32F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
+					const FFloat16* Src = reinterpret_cast<const FFloat16*>(SrcData);
+					ConvertFloat1(NumPixels, Dst, [Src](int64 Idx)
 					{
-						Data[Idx * 3] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+						float Values[4];
+						FPlatformMath::VectorLoadHalf(Values, reinterpret_cast<const uint16*>(Src + Idx));
+						return VectorLoad(Values);
+					}, [Src](int64 Idx)
+					{
+						return Src[Idx].GetFloat();
+					});
 				}
 				break;
-			case ETextureFormat::RGBA8:
+			case ERawImageFormat::R32F:
 				{
-					const TArrayView64<FLinearColor> RawData = Image.AsRGBA32F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
+					const float* Src = reinterpret_cast<const float*>(SrcData);
+					ConvertFloat1(NumPixels, Dst, [Src](int64 Idx)
 					{
-						Data[Idx * 4] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 3] = RawData[Idx].A * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+						return VectorLoad(Src + Idx);
+					}, [Src](int64 Idx)
+					{
+						return Src[Idx];
+					});
 				}
 				break;
+			default:
+				return false;
 			}
-			break;
-		case ERawImageFormat::G16:
-			{
-				const TArrayView64<uint16> RawData = Image.AsG16();
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-				for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
-				{
-					Data[Idx] = RawData[Idx] / (float)TNumericLimits<uint16>::Max() * TNumericLimits<uint8>::Max();
-				}
-				UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Data.GetData());
-			}
-			break;
-		case ERawImageFormat::R16F:
-			{
-				const TArrayView64<FFloat16> RawData = Image.AsR16F();
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-				for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
-				{
-					Data[Idx] = RawData[Idx] * TNumericLimits<uint8>::Max();
-				}
-				UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Data.GetData());
-			}
-			break;
-		case ERawImageFormat::R32F:
-			{
-				const TArrayView64<float> RawData = Image.AsR32F();
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-				for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
-				{
-					Data[Idx] = RawData[Idx] * TNumericLimits<uint8>::Max();
-				}
-				UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Data.GetData());
-			}
-			break;
-		default:
-			ensure(false);
-			return;
+			return true;
 		}
 	}
 
-	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D)
+	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTexture2D* Texture2D)
 	{
-		if (RenderTarget2D == nullptr)
+		if (Texture2D == nullptr)
+		{
+			return;
+		}
+		FImage Image;
+		if (FImageUtils::GetTexture2DSourceImage(Texture2D, Image) == false)
 		{
 			return;
 		}
 
-		FTextureRenderTarget2DResource* RTResource = static_cast<FTextureRenderTarget2DResource*>(RenderTarget2D->GameThread_GetRenderTargetResource());
-		if (!ensure(RTResource))
+		using namespace PixelConversion;
+		const int64 NumPixels = Image.GetNumPixels();
+		const bool bSingleChannel = Image.Format == ERawImageFormat::G8 || Image.Format == ERawImageFormat::G16 || Image.Format == ERawImageFormat::R16F || Image.Format == ERawImageFormat::R32F;
+		if (bSingleChannel && TextureFormat != ETextureFormat::Alpha8)
 		{
+			TextureFormat = ETextureFormat::Gray8;
+		}
+		if (Image.Format == ERawImageFormat::G8)
+		{
+			UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Image.AsG8().GetData());
 			return;
 		}
-		TArray<FColor> RawData;
-		if (!ensure(RTResource->ReadPixels(RawData, {}, FIntRect{ 0, 0, RenderTarget2D->SizeX, RenderTarget2D->SizeY })))
+
+		TArray<uint8> Data;
+		Data.SetNumUninitialized(NumPixels * GetBytesPerPixel(TextureFormat));
+		if (!ensure(ConvertImage(Image.Format, Image.RawData.GetData(), NumPixels, TextureFormat, Data.GetData())))
 		{
 			return;
 		}
+		UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+	}
 
-		const ETextureRenderTargetFormat Format = RenderTarget2D->RenderTargetFormat;
-		const bool bSingleChannel = Format == RTF_R8 || Format == RTF_R16f || Format == RTF_R32f;
+	void UpdateColorDataToWS(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, int32 Width, int32 Height, bool bSingleChannel, const TArray<FColor>& RawData)
+	{
 		if (bSingleChannel && TextureFormat != ETextureFormat::Alpha8)
 		{
 			TextureFormat = ETextureFormat::Gray8;
@@ -418,7 +469,7 @@ namespace UnrealImGui
 		case ETextureFormat::Gray8:
 			{
 				TArray<uint8> Data;
-				Data.SetNumUninitialized(RenderTarget2D->SizeX * RenderTarget2D->SizeY);
+				Data.SetNumUninitialized(Width * Height);
 				if (bSingleChannel)
 				{
 					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
@@ -433,26 +484,26 @@ namespace UnrealImGui
 						Data[Idx] = RawData[Idx].A;
 					}
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, Data.GetData());
+				UpdateTextureDataToWS(Handle, TextureFormat, Width, Height, Data.GetData());
 			}
 			break;
 		case ETextureFormat::RGB8:
 			{
 				TArray<uint8> Data;
-				Data.SetNumUninitialized(RenderTarget2D->SizeX * RenderTarget2D->SizeY * 3);
+				Data.SetNumUninitialized(Width * Height * 3);
 				for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
 				{
 					Data[Idx * 3] = RawData[Idx].R;
 					Data[Idx * 3 + 1] = RawData[Idx].G;
 					Data[Idx * 3 + 2] = RawData[Idx].B;
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, Data.GetData());
+				UpdateTextureDataToWS(Handle, TextureFormat, Width, Height, Data.GetData());
 			}
 			break;
 		case ETextureFormat::RGBA8:
 			{
 				TArray<uint8> Data;
-				Data.SetNumUninitialized(RenderTarget2D->SizeX * RenderTarget2D->SizeY * 4);
+				Data.SetNumUninitialized(Width * Height * 4);
 				for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
 				{
 					Data[Idx * 4] = RawData[Idx].R;
@@ -460,7 +511,7 @@ namespace UnrealImGui
 					Data[Idx * 4 + 2] = RawData[Idx].B;
 					Data[Idx * 4 + 3] = RawData[Idx].A;
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, Data.GetData());
+				UpdateTextureDataToWS(Handle, TextureFormat, Width, Height, Data.GetData());
 			}
 			break;
 		default:
@@ -468,6 +519,389 @@ namespace UnrealImGui
 		}
 	}
 
+	namespace RenderTargetReadback
+	{
+		TAutoConsoleVariable<float> CVar_MaxUpdateRate
+		{
+			TEXT("ImGui.RenderTargetReadback.MaxUpdateRate"),
+			10.f,
+			TEXT("Max readbacks per second of a render target shown remotely, 0 reads back on every update"),
+		};
+
+		TAutoConsoleVariable<bool> CVar_Async
+		{
+			TEXT("ImGui.RenderTargetReadback.Async"),
+			true,
+			TEXT("Read render targets back through a pipelined GPU readback, false reads them synchronously and flushes rendering"),
+		};
+
+		// shared with the render thread, the copy lands a few frames later and is picked up by Tick
+		struct FRequest
+		{
+			FRHIGPUTextureReadback Readback{ TEXT("ImGuiRenderTargetReadback") };
+			std::atomic<bool> bCopyEnqueued{ false };
+			FImGuiTextureHandle Handle;
+			ETextureFormat TextureFormat;
+			EPixelFormat PixelFormat;
+			int32 Width;
+			int32 Height;
+			bool bSingleChannel;
+		};
+
+		struct FRenderTarget
+		{
+			FImGuiTextureHandle Handle;
+			TWeakObjectPtr<UTextureRenderTarget2D> RenderTarget;
+			TSharedPtr<FRequest, ESPMode::ThreadSafe> Request;
+			double LastRequestTime = -DBL_MAX;
+			bool bLocking = false;
+			// an update arrived while busy or rate limited, Tick reads it back once allowed
+			bool bPending = false;
+			ETextureFormat PendingTextureFormat;
+			bool bPendingSingleChannel = false;
+		};
+		TMap<uint32, FRenderTarget> RenderTargets;
+		FTSTicker::FDelegateHandle TickHandle;
+
+		bool IsSupported(EPixelFormat PixelFormat)
+		{
+			switch (PixelFormat)
+			{
+			case PF_B8G8R8A8:
+			case PF_R8G8B8A8:
+			case PF_G8:
+			case PF_R8:
+			case PF_FloatRGBA:
+			case PF_A32B32G32R32F:
+			case PF_R16F:
+			case PF_R32_FLOAT:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// same result as ReadPixels with the default flags, float formats are converted to sRGB
+		void ConvertToColors(EPixelFormat PixelFormat, int32 Width, int32 Height, const uint8* Src, int32 RowPitchInPixels, TArray<FColor>& OutColors)
+		{
+			OutColors.SetNumUninitialized(Width * Height);
+			const int32 BytesPerPixel = GPixelFormats[PixelFormat].BlockBytes;
+			for (int32 Y = 0; Y < Height; ++Y)
+			{
+				const uint8* Row = Src + (SIZE_T)Y * RowPitchInPixels * BytesPerPixel;
+				FColor* Dst = OutColors.GetData() + Y * Width;
+				switch (PixelFormat)
+				{
+				case PF_B8G8R8A8:
+					FMemory::Memcpy(Dst, Row, Width * sizeof(FColor));
+					break;
+				case PF_R8G8B8A8:
+					for (int32 X = 0; X < Width; ++X)
+					{
+						Dst[X] = FColor{ Row[X * 4], Row[X * 4 + 1], Row[X * 4 + 2], Row[X * 4 + 3] };
+					}
+					break;
+				case PF_G8:
+				case PF_R8:
+					for (int32 X = 0; X < Width; ++X)
+					{
+						Dst[X] = FColor{ Row[X], Row[X], Row[X], 255 };
+					}
+					break;
+				case PF_FloatRGBA:
+					for (int32 X = 0; X < Width; ++X)
+					{
+						Dst[X] = FLinearColor{ reinterpret_cast<const FFloat16Color*>(Row)[X] }.ToFColor(true);
+					}
+					break;
+				case PF_A32B32G32R32F:
+					for (int32 X = 0; X < Width; ++X)
+					{
+						Dst[X] = reinterpret_cast<const FLinearColor*>(Row)[X].ToFColor(true);
+					}
+					break;
+				case PF_R16F:
+					for (int32 X = 0; X < Width; ++X)
+					{
+						const float V = reinterpret_cast<const FFloat16*>(Row)[X];
+						Dst[X] = FLinearColor{ V, V, V, 1.f }.ToFColor(true);
+					}
+					break;
+				case PF_R32_FLOAT:
+					for (int32 X = 0; X < Width; ++X)
+					{
+						const float V = reinterpret_cast<const float*>(Row)[X];
+						Dst[X] = FLinearColor{ V, V, V, 1.f }.ToFColor(true);
+					}
+					break;
+				default:
+					checkNoEntry();
+				}
+			}
+		}
+
+		bool IsBusy(const FRenderTarget& RenderTarget)
+		{
+			return RenderTarget.bLocking || (RenderTarget.Request.IsValid() && RenderTarget.Request->bCopyEnqueued);
+		}
+
+		bool IsRateLimited(const FRenderTarget& RenderTarget, double Now)
+		{
+			const float MaxUpdateRate = CVar_MaxUpdateRate.GetValueOnGameThread();
+			return MaxUpdateRate > 0.f && Now - RenderTarget.LastRequestTime < 1.0 / MaxUpdateRate;
+		}
+
+		void EnqueueCopy(FImGuiTextureHandle Handle, FRenderTarget& RenderTarget, UTextureRenderTarget2D* RenderTarget2D, ETextureFormat TextureFormat, bool bSingleChannel, double Now)
+		{
+			RenderTarget.LastRequestTime = Now;
+			RenderTarget.bPending = false;
+
+			if (RenderTarget.Request.IsValid() == false)
+			{
+				RenderTarget.Request = MakeShared<FRequest, ESPMode::ThreadSafe>();
+			}
+			FRequest& NewRequest = *RenderTarget.Request;
+			NewRequest.Handle = Handle;
+			NewRequest.TextureFormat = TextureFormat;
+			NewRequest.PixelFormat = RenderTarget2D->GetFormat();
+			NewRequest.Width = RenderTarget2D->SizeX;
+			NewRequest.Height = RenderTarget2D->SizeY;
+			NewRequest.bSingleChannel = bSingleChannel;
+			ENQUEUE_RENDER_COMMAND(ImGuiRenderTargetReadbackCopy)([Request = RenderTarget.Request, RenderTargetPtr = TWeakObjectPtr<UTextureRenderTarget2D>(RenderTarget2D)](FRHICommandListImmediate& RHICmdList)
+			{
+				const UTextureRenderTarget2D* RT = RenderTargetPtr.Get();
+				const FTextureResource* RenderTargetResource = RT ? RT->GetResource() : nullptr;
+				if (RenderTargetResource == nullptr || RenderTargetResource->GetTexture2DRHI() == nullptr)
+				{
+					return;
+				}
+				Request->Readback.EnqueueCopy(RHICmdList, RenderTargetResource->GetTexture2DRHI());
+				Request->bCopyEnqueued = true;
+			});
+		}
+
+		bool Tick(float DeltaTime)
+		{
+			const double Now = FPlatformTime::Seconds();
+			for (auto It = RenderTargets.CreateIterator(); It; ++It)
+			{
+				FRenderTarget& RenderTarget = It.Value();
+				if (RenderTarget.RenderTarget.IsValid() == false)
+				{
+					if (RenderTarget.bLocking == false)
+					{
+						It.RemoveCurrent();
+					}
+					continue;
+				}
+				const TSharedPtr<FRequest, ESPMode::ThreadSafe>& Request = RenderTarget.Request;
+				if (RenderTarget.bPending && IsBusy(RenderTarget) == false && IsRateLimited(RenderTarget, Now) == false)
+				{
+					UTextureRenderTarget2D* RenderTarget2D = RenderTarget.RenderTarget.Get();
+					if (RenderTarget2D->GetResource() && IsSupported(RenderTarget2D->GetFormat()))
+					{
+						EnqueueCopy(RenderTarget.Handle, RenderTarget, RenderTarget2D, RenderTarget.PendingTextureFormat, RenderTarget.bPendingSingleChannel, Now);
+					}
+					else
+					{
+						RenderTarget.bPending = false;
+					}
+					continue;
+				}
+				if (Request.IsValid() == false || RenderTarget.bLocking || Request->bCopyEnqueued == false || Request->Readback.IsReady() == false)
+				{
+					continue;
+				}
+
+				// mapping the staging texture has to happen on the render thread, the conversion runs there too
+				RenderTarget.bLocking = true;
+				ENQUEUE_RENDER_COMMAND(ImGuiRenderTargetReadbackLock)([Request](FRHICommandListImmediate& RHICmdList)
+				{
+					int32 RowPitchInPixels = 0;
+					const uint8* Src = static_cast<const uint8*>(Request->Readback.Lock(RowPitchInPixels));
+					TArray<FColor> Colors;
+					if (Src)
+					{
+						ConvertToColors(Request->PixelFormat, Request->Width, Request->Height, Src, RowPitchInPixels, Colors);
+					}
+					Request->Readback.Unlock();
+					Request->bCopyEnqueued = false;
+
+					AsyncTask(ENamedThreads::GameThread, [Request, Colors = MoveTemp(Colors)]
+					{
+						// released while the readback was in flight
+						FRenderTarget* RenderTarget = RenderTargets.Find(Request->Handle);
+						if (RenderTarget == nullptr)
+						{
+							return;
+						}
+						RenderTarget->bLocking = false;
+						if (Colors.Num() > 0)
+						{
+							UpdateColorDataToWS(Request->Handle, Request->TextureFormat, Request->Width, Request->Height, Request->bSingleChannel, Colors);
+						}
+					});
+				});
+			}
+			if (RenderTargets.Num() == 0)
+			{
+				TickHandle.Reset();
+				return false;
+			}
+			return true;
+		}
+
+		// returns false when the render target has to be read synchronously
+		bool Request(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D, bool bSingleChannel)
+		{
+			if (CVar_Async.GetValueOnGameThread() == false)
+			{
+				return false;
+			}
+			const FTextureResource* Resource = RenderTarget2D->GetResource();
+			const EPixelFormat PixelFormat = RenderTarget2D->GetFormat();
+			if (Resource == nullptr || IsSupported(PixelFormat) == false)
+			{
+				return false;
+			}
+
+			FRenderTarget& RenderTarget = RenderTargets.FindOrAdd(Handle);
+			RenderTarget.Handle = Handle;
+			RenderTarget.RenderTarget = RenderTarget2D;
+			if (TickHandle.IsValid() == false)
+			{
+				TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+			}
+
+			// a readback is in flight or the last one is too recent, keep the latest update for Tick so it isn't lost
+			const double Now = FPlatformTime::Seconds();
+			if (IsBusy(RenderTarget) || IsRateLimited(RenderTarget, Now))
+			{
+				RenderTarget.bPending = true;
+				RenderTarget.PendingTextureFormat = TextureFormat;
+				RenderTarget.bPendingSingleChannel = bSingleChannel;
+				return true;
+			}
+			EnqueueCopy(Handle, RenderTarget, RenderTarget2D, TextureFormat, bSingleChannel, Now);
+			return true;
+		}
+	}
+
+	namespace TextureIdManager
+	{
+		void Touch(uint32 Id)
+		{
+			FTextureEntry* Entry = Entries.Find(Id);
+			if (Entry == nullptr)
+			{
+				return;
+			}
+			Entry->LastUsedFrame = GFrameCounter;
+			if (Entry->LruNode && Entry->LruNode != LruList.GetHead())
+			{
+				LruList.RemoveNode(Entry->LruNode, false);
+				LruList.AddHead(Entry->LruNode);
+			}
+		}
+
+		void SetEvictable(uint32 Id, bool bEvictable)
+		{
+			FTextureEntry& Entry = Entries.FindOrAdd(Id);
+			Entry.bEvictable = bEvictable;
+			if (bEvictable == false && Entry.LruNode)
+			{
+				LruList.RemoveNode(Entry.LruNode);
+				Entry.LruNode = nullptr;
+			}
+		}
+
+		void Remove(uint32 Id)
+		{
+			if (const FTextureEntry* Entry = Entries.Find(Id))
+			{
+				TotalBytes -= Entry->Bytes;
+				if (Entry->LruNode)
+				{
+					LruList.RemoveNode(Entry->LruNode);
+				}
+				Entries.Remove(Id);
+			}
+			if (const TWeakObjectPtr<const UTexture>* Texture = IdTextureMap.Find(Id))
+			{
+				HandleIdMap.Remove(*Texture);
+				IdTextureMap.Remove(Id);
+			}
+			RenderTargetReadback::RenderTargets.Remove(Id);
+			if (Private::RemoveTextureData_WS)
+			{
+				Private::RemoveTextureData_WS(Id);
+			}
+		}
+
+		void OnUploaded(uint32 Id, int64 Bytes)
+		{
+			FTextureEntry& Entry = Entries.FindOrAdd(Id);
+			TotalBytes += Bytes - Entry.Bytes;
+			Entry.Bytes = Bytes;
+			// only drawing touches a texture, render targets are read back whether they are drawn or not
+			if (Entry.LruNode == nullptr && Entry.RefCount == 0 && Entry.bEvictable)
+			{
+				LruList.AddHead(Id);
+				Entry.LruNode = LruList.GetHead();
+				Entry.LastUsedFrame = GFrameCounter;
+			}
+
+			const int64 Budget = (int64)CVar_TextureBudgetMB.GetValueOnAnyThread() * 1024 * 1024;
+			while (Budget > 0 && TotalBytes > Budget && LruList.Num() > 0)
+			{
+				// textures drawn in this frame stay, evicting them would only upload them again
+				const uint32 LeastRecentId = LruList.GetTail()->GetValue();
+				if (Entries.FindChecked(LeastRecentId).LastUsedFrame == GFrameCounter)
+				{
+					break;
+				}
+				Remove(LeastRecentId);
+			}
+		}
+	}
+
+	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D)
+	{
+		if (RenderTarget2D == nullptr)
+		{
+			return;
+		}
+
+		const ETextureRenderTargetFormat Format = RenderTarget2D->RenderTargetFormat;
+		const bool bSingleChannel = Format == RTF_R8 || Format == RTF_R16f || Format == RTF_R32f;
+
+		// nothing to read back without a RHI, a black image keeps the handle valid for the remote clients
+		if (FApp::CanEverRender() == false)
+		{
+			TArray<FColor> RawData;
+			RawData.SetNumZeroed(RenderTarget2D->SizeX * RenderTarget2D->SizeY);
+			UpdateColorDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, bSingleChannel, RawData);
+			return;
+		}
+
+		if (RenderTargetReadback::Request(Handle, TextureFormat, RenderTarget2D, bSingleChannel))
+		{
+			return;
+		}
+
+		FTextureRenderTarget2DResource* RTResource = static_cast<FTextureRenderTarget2DResource*>(RenderTarget2D->GameThread_GetRenderTargetResource());
+		if (!ensure(RTResource))
+		{
+			return;
+		}
+		TArray<FColor> RawData;
+		if (!ensure(RTResource->ReadPixels(RawData, {}, FIntRect{ 0, 0, RenderTarget2D->SizeX, RenderTarget2D->SizeY })))
+		{
+			return;
+		}
+		UpdateColorDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, bSingleChannel, RawData);
+	}
+
 	FImGuiTextureHandle FindOrAddTexture(ETextureFormat TextureFormat, UTexture* Texture)
 	{
 		if (Texture == nullptr)
@@ -477,8 +911,10 @@ namespace UnrealImGui
 
 		bool bCreated;
 		const FImGuiTextureHandle Handle = FImGuiTextureHandle::FindOrCreateHandle(Texture, bCreated);
+		TextureIdManager::Touch(Handle);
 		if (bCreated)
 		{
+			TextureIdManager::SetEvictable(Handle, true);
 			if (UTexture2D* Texture2D = Cast<UTexture2D>(Texture))
 			{
 				UpdateTextureData(Handle, TextureFormat, Texture2D);
@@ -500,6 +936,90 @@ namespace UnrealImGui
 		using namespace TextureIdManager;
 		return IdTextureMap.FindRef(ImTextureId).Get();
 	}
+
+	void ReleaseTexture(FImGuiTextureHandle Handle)
+	{
+		if (Handle.IsValid())
+		{
+			TextureIdManager::Remove(Handle);
+		}
+	}
+
+	void TouchTextures(const ImDrawData* DrawData)
+	{
+		if (DrawData == nullptr || TextureIdManager::LruList.Num() == 0)
+		{
+			return;
+		}
+		for (int32 Idx = 0; Idx < DrawData->CmdListsCount; ++Idx)
+		{
+			ImTextureID LastTextureId = 0;
+			for (const ImDrawCmd& Cmd : DrawData->CmdLists[Idx]->CmdBuffer)
+			{
+				// consecutive commands mostly share their texture
+				if (Cmd.TextureId != LastTextureId)
+				{
+					LastTextureId = Cmd.TextureId;
+					TextureIdManager::Touch((uint32)Cmd.TextureId);
+				}
+			}
+		}
+	}
+
+	void AddTextureRef(FImGuiTextureHandle Handle)
+	{
+		if (Handle.IsValid() == false)
+		{
+			return;
+		}
+		using namespace TextureIdManager;
+		FTextureEntry& Entry = Entries.FindOrAdd(Handle);
+		Entry.RefCount += 1;
+		if (Entry.LruNode)
+		{
+			LruList.RemoveNode(Entry.LruNode);
+			Entry.LruNode = nullptr;
+		}
+	}
+
+	void RemoveTextureRef(FImGuiTextureHandle Handle)
+	{
+		using namespace TextureIdManager;
+		FTextureEntry* Entry = Entries.Find(Handle);
+		if (Entry && --Entry->RefCount <= 0)
+		{
+			Remove(Handle);
+		}
+	}
+}
+
+FImGuiTextureRef::FImGuiTextureRef(FImGuiTextureHandle InHandle)
+	: Handle(InHandle)
+{
+	UnrealImGui::AddTextureRef(Handle);
+}
+
+FImGuiTextureRef::FImGuiTextureRef(const FImGuiTextureRef& Other)
+	: Handle(Other.Handle)
+{
+	UnrealImGui::AddTextureRef(Handle);
+}
+
+FImGuiTextureRef::FImGuiTextureRef(FImGuiTextureRef&& Other)
+	: Handle(Other.Handle)
+{
+	Other.Handle = {};
+}
+
+FImGuiTextureRef& FImGuiTextureRef::operator=(FImGuiTextureRef Other)
+{
+	Swap(Handle, Other.Handle);
+	return *this;
+}
+
+FImGuiTextureRef::~FImGuiTextureRef()
+{
+	UnrealImGui::RemoveTextureRef(Handle);
 }
 
 FImGuiTextureHandle::FImGuiTextureHandle(const UTexture* Texture)
@@ -507,6 +1027,9 @@ FImGuiTextureHandle::FImGuiTextureHandle(const UTexture* Texture)
 	using namespace UnrealImGui::TextureIdManager;
 	bool bCreated;
 	ImTextureId = FindOrCreateHandle(Texture, bCreated).ImTextureId;
+	// a handle kept by the caller, even for a texture FindOrAddTexture created first
+	SetEvictable(ImTextureId, false);
+	Touch(ImTextureId);
 }
 
 FImGuiTextureHandle FImGuiTextureHandle::MakeUnique()
@@ -529,3 +1052,201 @@ FImGuiTextureHandle FImGuiTextureHandle::FindOrCreateHandle(const UTexture* Text
 	}
 	return FImGuiTextureHandle{ Id };
 }
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+namespace UnrealImGui
+{
+	namespace PixelConversionTests
+	{
+		// below the ParallelFor threshold and above it, both with a tail that isn't a multiple of four pixels
+		const int64 NumPixelsToTest[] = { 67, PixelConversion::ParallelMinPixels + 5 };
+
+		constexpr float RGBA16Scale = (float)TNumericLimits<uint8>::Max() / TNumericLimits<uint16>::Max();
+
+		// Reference(PixelIdx, Channel) gives the expected byte of the rgba channel, single channel sources only use channel 0
+		void TestConvertImage(FAutomationTestBase& Test, const TCHAR* What, ERawImageFormat::Type SrcFormat, const void* Src, int64 NumPixels, bool bSingleChannel, TFunctionRef<uint8(int64, int32)> Reference)
+		{
+			constexpr uint8 Guard = 0xCD;
+			constexpr int32 NumGuardBytes = 16;
+			const ETextureFormat TextureFormats[] = { ETextureFormat::Alpha8, ETextureFormat::Gray8, ETextureFormat::RGB8, ETextureFormat::RGBA8 };
+			const TCHAR* TextureFormatNames[] = { TEXT("Alpha8"), TEXT("Gray8"), TEXT("RGB8"), TEXT("RGBA8") };
+			for (int32 FormatIdx = 0; FormatIdx < UE_ARRAY_COUNT(TextureFormats); ++FormatIdx)
+			{
+				const ETextureFormat TextureFormat = TextureFormats[FormatIdx];
+				const int32 BytesPerPixel = bSingleChannel ? 1 : PixelConversion::GetBytesPerPixel(TextureFormat);
+				const int32 FirstChannel = bSingleChannel ? 0 : BytesPerPixel == 1 ? 3 : 0;
+
+				TArray<uint8> Data;
+				Data.Init(Guard, NumPixels * BytesPerPixel + NumGuardBytes);
+				if (Test.TestTrue(FString::Printf(TEXT("%s to %s is supported"), What, TextureFormatNames[FormatIdx]), PixelConversion::ConvertImage(SrcFormat, static_cast<const uint8*>(Src), NumPixels, TextureFormat, Data.GetData())) == false)
+				{
+					continue;
+				}
+
+				int64 NumMismatches = 0;
+				int64 FirstMismatch = INDEX_NONE;
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					for (int32 Channel = 0; Channel < BytesPerPixel; ++Channel)
+					{
+						if (Data[Idx * BytesPerPixel + Channel] != Reference(Idx, FirstChannel + Channel))
+						{
+							NumMismatches += 1;
+							FirstMismatch = FirstMismatch == INDEX_NONE ? Idx : FirstMismatch;
+						}
+					}
+				}
+				if (NumMismatches > 0)
+				{
+					Test.AddError(FString::Printf(TEXT("%s to %s, %lld pixels: %lld bytes differ from the scalar conversion, first at pixel %lld"), What, TextureFormatNames[FormatIdx], NumPixels, NumMismatches, FirstMismatch));
+				}
+				for (int32 GuardIdx = 0; GuardIdx < NumGuardBytes; ++GuardIdx)
+				{
+					if (Data[NumPixels * BytesPerPixel + GuardIdx] != Guard)
+					{
+						Test.AddError(FString::Printf(TEXT("%s to %s, %lld pixels: wrote past the end of the output"), What, TextureFormatNames[FormatIdx], NumPixels));
+						break;
+					}
+				}
+			}
+		}
+
+		uint8 Saturated(float Value)
+		{
+			return (uint8)FMath::Clamp(Value * TNumericLimits<uint8>::Max(), 0.f, 255.f);
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FImGuiPixelConversionScalarTest, "ImGui.Texture.PixelConversion.MatchesScalar", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FImGuiPixelConversionScalarTest::RunTest(const FString& Parameters)
+{
+	using namespace UnrealImGui;
+	using namespace UnrealImGui::PixelConversionTests;
+
+	// the formulas the conversion replaced, float channels in [0, 1] so the truncating casts are defined
+	FRandomStream Random{ 1234 };
+	for (const int64 NumPixels : NumPixelsToTest)
+	{
+		TArray<FColor> BGRA8;
+		TArray<uint16> RGBA16;
+		TArray<FFloat16Color> RGBA16F;
+		TArray<FLinearColor> RGBA32F;
+		TArray<uint16> G16;
+		TArray<FFloat16> R16F;
+		TArray<float> R32F;
+		for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+		{
+			BGRA8.Add(FColor{ (uint8)Random.RandHelper(256), (uint8)Random.RandHelper(256), (uint8)Random.RandHelper(256), (uint8)Random.RandHelper(256) });
+			for (int32 Channel = 0; Channel < 4; ++Channel)
+			{
+				RGBA16.Add((uint16)Random.RandHelper(65536));
+			}
+			const FLinearColor Color{ Random.FRand(), Random.FRand(), Random.FRand(), Random.FRand() };
+			RGBA16F.Add(FFloat16Color{ Color });
+			RGBA32F.Add(Color);
+			G16.Add((uint16)Random.RandHelper(65536));
+			R16F.Add(FFloat16{ Random.FRand() });
+			R32F.Add(Random.FRand());
+		}
+
+		TestConvertImage(*this, TEXT("BGRA8"), ERawImageFormat::BGRA8, BGRA8.GetData(), NumPixels, false, [&](int64 Idx, int32 Channel)
+		{
+			const FColor& Color = BGRA8[Idx];
+			return Channel == 0 ? Color.R : Channel == 1 ? Color.G : Channel == 2 ? Color.B : Color.A;
+		});
+		TestConvertImage(*this, TEXT("BGRE8"), ERawImageFormat::BGRE8, BGRA8.GetData(), NumPixels, false, [&](int64 Idx, int32 Channel)
+		{
+			const FColor& Color = BGRA8[Idx];
+			return Channel == 0 ? Color.R : Channel == 1 ? Color.G : Channel == 2 ? Color.B : Color.A;
+		});
+		TestConvertImage(*this, TEXT("RGBA16"), ERawImageFormat::RGBA16, RGBA16.GetData(), NumPixels, false, [&](int64 Idx, int32 Channel)
+		{
+			return (uint8)(RGBA16[Idx * 4 + Channel] * RGBA16Scale);
+		});
+		TestConvertImage(*this, TEXT("RGBA16F"), ERawImageFormat::RGBA16F, RGBA16F.GetData(), NumPixels, false, [&](int64 Idx, int32 Channel)
+		{
+			const FFloat16Color& Color = RGBA16F[Idx];
+			return (uint8)((Channel == 0 ? Color.R : Channel == 1 ? Color.G : Channel == 2 ? Color.B : Color.A) * TNumericLimits<uint8>::Max());
+		});
+		TestConvertImage(*this, TEXT("RGBA32F"), ERawImageFormat::RGBA32F, RGBA32F.GetData(), NumPixels, false, [&](int64 Idx, int32 Channel)
+		{
+			return (uint8)(RGBA32F[Idx].Component(Channel) * TNumericLimits<uint8>::Max());
+		});
+		TestConvertImage(*this, TEXT("G16"), ERawImageFormat::G16, G16.GetData(), NumPixels, true, [&](int64 Idx, int32 Channel)
+		{
+			return (uint8)(G16[Idx] / (float)TNumericLimits<uint16>::Max() * TNumericLimits<uint8>::Max());
+		});
+		TestConvertImage(*this, TEXT("R16F"), ERawImageFormat::R16F, R16F.GetData(), NumPixels, true, [&](int64 Idx, int32 Channel)
+		{
+			return (uint8)(R16F[Idx] * TNumericLimits<uint8>::Max());
+		});
+		TestConvertImage(*this, TEXT("R32F"), ERawImageFormat::R32F, R32F.GetData(), NumPixels, true, [&](int64 Idx, int32 Channel)
+		{
+			return (uint8)(R32F[Idx] * TNumericLimits<uint8>::Max());
+		});
+	}
+
+	// the integer division has to agree with the float scaling for every 16 bit value, not only the random ones
+	TArray<uint16> AllG16;
+	for (int32 Value = 0; Value <= TNumericLimits<uint16>::Max(); ++Value)
+	{
+		AllG16.Add((uint16)Value);
+	}
+	TestConvertImage(*this, TEXT("G16 all values"), ERawImageFormat::G16, AllG16.GetData(), AllG16.Num(), true, [&](int64 Idx, int32 Channel)
+	{
+		return (uint8)(AllG16[Idx] / (float)TNumericLimits<uint16>::Max() * TNumericLimits<uint8>::Max());
+	});
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FImGuiPixelConversionHDRTest, "ImGui.Texture.PixelConversion.ClampsHDR", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FImGuiPixelConversionHDRTest::RunTest(const FString& Parameters)
+{
+	using namespace UnrealImGui;
+	using namespace UnrealImGui::PixelConversionTests;
+
+	// out of range values saturate to 0 and 255 instead of the undefined float to byte cast
+	const float Values[] = { -UE_MAX_FLT, -100.f, -1.f, -0.25f, 0.f, 0.5f, 1.f, 1.25f, 7.f, 100.f, 60000.f, UE_MAX_FLT, -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+	for (const int64 NumPixels : NumPixelsToTest)
+	{
+		TArray<FFloat16Color> RGBA16F;
+		TArray<FLinearColor> RGBA32F;
+		TArray<FFloat16> R16F;
+		TArray<float> R32F;
+		for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+		{
+			const FLinearColor Color{ Values[Idx % UE_ARRAY_COUNT(Values)], Values[(Idx + 3) % UE_ARRAY_COUNT(Values)], Values[(Idx + 6) % UE_ARRAY_COUNT(Values)], Values[(Idx + 9) % UE_ARRAY_COUNT(Values)] };
+			RGBA16F.Add(FFloat16Color{ Color });
+			RGBA32F.Add(Color);
+			R16F.Add(FFloat16{ Color.R });
+			R32F.Add(Color.R);
+		}
+
+		TestConvertImage(*this, TEXT("HDR RGBA16F"), ERawImageFormat::RGBA16F, RGBA16F.GetData(), NumPixels, false, [&](int64 Idx, int32 Channel)
+		{
+			const FFloat16Color& Color = RGBA16F[Idx];
+			return Saturated(Channel == 0 ? Color.R : Channel == 1 ? Color.G : Channel == 2 ? Color.B : Color.A);
+		});
+		TestConvertImage(*this, TEXT("HDR RGBA32F"), ERawImageFormat::RGBA32F, RGBA32F.GetData(), NumPixels, false, [&](int64 Idx, int32 Channel)
+		{
+			return Saturated(RGBA32F[Idx].Component(Channel));
+		});
+		TestConvertImage(*this, TEXT("HDR R16F"), ERawImageFormat::R16F, R16F.GetData(), NumPixels, true, [&](int64 Idx, int32 Channel)
+		{
+			return Saturated(R16F[Idx]);
+		});
+		TestConvertImage(*this, TEXT("HDR R32F"), ERawImageFormat::R32F, R32F.GetData(), NumPixels, true, [&](int64 Idx, int32 Channel)
+		{
+			return Saturated(R32F[Idx]);
+		});
+	}
+	return true;
+}
+
+#endif
@@ -13,6 +13,9 @@ struct IMGUI_API FImGuiDelegates
 	static FOnImGui_WS_Enable OnImGui_WS_Enable;
 	DECLARE_MULTICAST_DELEGATE(FOnImGui_WS_Disable);
 	static FOnImGui_WS_Disable OnImGui_WS_Disable;
+	// game thread, leaves the idle rate of the ImGui_WS UI, e.g. when a panel's data changed while nobody interacts with it
+	DECLARE_MULTICAST_DELEGATE(FOnImGui_WS_WakeUp);
+	static FOnImGui_WS_WakeUp OnImGui_WS_WakeUp;
 
 	DECLARE_MULTICAST_DELEGATE(FOnImGuiLocalPanelEnable);
 	static FOnImGuiLocalPanelEnable OnImGuiLocalPanelEnable;
@@ -31,6 +31,25 @@ enum class EImGuiFontGlyphRanges : uint8
 	Vietnamese,
 };
 
+USTRUCT()
+struct FImGuiWSCompressionSettings
+{
+	GENERATED_BODY()
+
+	// Negotiate permessage-deflate with the browser, every message sent to the web is compressed
+	UPROPERTY(EditAnywhere, Category = Compression)
+	bool bPerMessageDeflate = false;
+	// zlib compression level of permessage-deflate, 1 is fastest, 9 is smallest
+	UPROPERTY(EditAnywhere, Category = Compression, meta = (ClampMin = 1, ClampMax = 9, EditCondition = bPerMessageDeflate))
+	int32 DeflateLevel = 1;
+	// Compress update messages with LZ4 before sending, decoded by incppect.js
+	UPROPERTY(EditAnywhere, Category = Compression, meta = (DisplayName = "LZ4 Frame"))
+	bool bLZ4Frame = false;
+	// Update messages smaller than this are sent without LZ4 framing
+	UPROPERTY(EditAnywhere, Category = Compression, meta = (ClampMin = 0, EditCondition = bLZ4Frame))
+	int32 MinCompressMessageSize = 1024;
+};
+
 UCLASS(Config = EditorPerProjectUserSettings)
 class IMGUI_API UImGuiPerUserSettings : public UObject
 {
@@ -78,18 +97,24 @@ public:
 	// 2. UE4Editor.exe GAMENAME -ExecCmds="ImGui.WS.Port 8890"
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	int32 EditorPort = 8892;
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true))
+	FImGuiWSCompressionSettings EditorCompression;
 
 	// Packaged Server
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (DisplayName = "Server Enable ImGui WS"))
 	bool bServerEnableImGui_WS = false;
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	int32 ServerPort = 8891;
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true))
+	FImGuiWSCompressionSettings ServerCompression;
 
 	// Packaged Game
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (DisplayName = "Game Enable ImGui WS"))
 	bool bGameEnableImGui_WS = false;
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	int32 GamePort = 8890;
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true))
+	FImGuiWSCompressionSettings GameCompression;
 
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	FString FontName = TEXT("zpix, 12px");
@@ -100,9 +125,34 @@ public:
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	EImGuiFontGlyphRanges FontGlyphRanges = EImGuiFontGlyphRanges::ChineseFull;
 
+	// Longest wait of the server thread while clients are connected, new draw data and client messages wake it up earlier
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	float ServerTickInterval = 1 / 120.f;
 
+	// Resend every draw list to web clients each N frames, 0 only resends the draw lists that changed
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true, ClampMin = 0))
+	int32 DrawDataKeyframeInterval = 600;
+
+	// Texture updates only send their changed 64x64 tiles, unless more than this share of the tiles changed
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true, ClampMin = 0, ClampMax = 1))
+	float TextureMaxDirtyRatio = 0.5f;
+
+	// PNG encode textures sent to web clients whenever that makes them smaller
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true))
+	bool bLosslessTextureEncoding = true;
+
+	// JPEG quality of opaque textures updated again within a second, such as render target previews, 0 keeps them lossless
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true, ClampMin = 0, ClampMax = 100))
+	int32 TextureLossyQuality = 0;
+
+	// Frames without input and without a visible change before the web UI drops to IdleTickRate
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true, ClampMin = 1))
+	int32 IdleFrameThreshold = 60;
+
+	// UI frames per second while idle, input, a changed frame or FImGuiDelegates::OnImGui_WS_WakeUp resume the full rate, 0 never idles
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", AdvancedDisplay, meta = (ConfigRestartRequired = true, ClampMin = 0))
+	float IdleTickRate = 4.f;
+
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (AllowedClasses = "/Script/ImGui_UnrealLayout.UnrealImGuiPanelBase"))
 	TArray<TSoftClassPtr<UObject>> BlueprintPanels;
 
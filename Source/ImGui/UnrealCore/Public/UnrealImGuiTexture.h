@@ -8,6 +8,7 @@
 class UTexture2D;
 class UTextureRenderTarget2D;
 class UTexture;
+struct ImDrawData;
 
 USTRUCT(BlueprintType)
 struct IMGUI_API FImGuiTextureHandle
@@ -37,6 +38,23 @@ private:
 	uint32 ImTextureId;
 };
 
+// keeps the texture of a handle alive on the remote clients, the texture is released with its last reference
+class IMGUI_API FImGuiTextureRef
+{
+public:
+	FImGuiTextureRef() = default;
+	explicit FImGuiTextureRef(FImGuiTextureHandle InHandle);
+	FImGuiTextureRef(const FImGuiTextureRef& Other);
+	FImGuiTextureRef(FImGuiTextureRef&& Other);
+	FImGuiTextureRef& operator=(FImGuiTextureRef Other);
+	~FImGuiTextureRef();
+
+	FImGuiTextureHandle GetHandle() const { return Handle; }
+	operator FImGuiTextureHandle() const { return Handle; }
+private:
+	FImGuiTextureHandle Handle;
+};
+
 namespace UnrealImGui
 {
 	enum class ETextureFormat : uint8
@@ -55,9 +73,19 @@ namespace UnrealImGui
 	IMGUI_API FImGuiTextureHandle FindOrAddTexture(ETextureFormat TextureFormat, UTexture* Texture);
 	IMGUI_API const UTexture* FindTexture(uint32 ImTextureId);
 
+	// removes the texture from the remote clients, a texture of FindOrAddTexture gets a new handle on its next use
+	IMGUI_API void ReleaseTexture(FImGuiTextureHandle Handle);
+	// referenced textures are never evicted by ImGui.TextureBudgetMB, the last RemoveTextureRef releases the texture
+	IMGUI_API void AddTextureRef(FImGuiTextureHandle Handle);
+	IMGUI_API void RemoveTextureRef(FImGuiTextureHandle Handle);
+	// marks the textures of the draw data as drawn this frame, ImGui.TextureBudgetMB evicts the least recently drawn first
+	IMGUI_API void TouchTextures(const ImDrawData* DrawData);
+
 	namespace Private
 	{
 		using FUpdateTextureData_WS = TFunction<void(FImGuiTextureHandle, ETextureFormat, int32, int32, const uint8*)>;
 		IMGUI_API extern FUpdateTextureData_WS UpdateTextureData_WS;
+		using FRemoveTextureData_WS = TFunction<void(uint32)>;
+		IMGUI_API extern FRemoveTextureData_WS RemoveTextureData_WS;
 	}
 }
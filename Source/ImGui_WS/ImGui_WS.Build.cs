@@ -23,6 +23,7 @@ public class ImGui_WS : ModuleRules
 	        "DeveloperSettings",
 	        "Slate",
 	        "SlateCore",
+	        "ImageWrapper",
 	        
 	        "ImGui",
 	        "ImGui_Slate",
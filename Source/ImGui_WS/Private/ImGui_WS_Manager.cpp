@@ -29,8 +29,11 @@
 #include "Framework/Docking/TabManager.h"
 #include "HAL/IConsoleManager.h"
 #include "HAL/PlatformFileManager.h"
+#include "Hash/xxhash.h"
 #include "HAL/Thread.h"
 #include "Interfaces/IPluginManager.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
 #include "Misc/FileHelper.h"
 #include "Misc/ScopeExit.h"
 #include "Record/imgui-ws-record.h"
@@ -151,6 +154,44 @@ FAutoConsoleCommand EndImGuiRecord
 	})
 };
 
+TAutoConsoleVariable<bool> CVar_FlightRecorder
+{
+	TEXT("ImGui.WS.FlightRecorder"),
+	false,
+	TEXT("Keep the last ImGui-WS frames in memory, dumped to ImGui.WS.RecordDirPath on ensure, hitch or ImGui.WS.DumpFlightRecorder")
+};
+TAutoConsoleVariable<float> CVar_FlightRecorderSeconds
+{
+	TEXT("ImGui.WS.FlightRecorder.Seconds"),
+	30.f,
+	TEXT("Seconds of frames kept by the flight recorder, applied when it is enabled")
+};
+TAutoConsoleVariable<int32> CVar_FlightRecorderBudgetMB
+{
+	TEXT("ImGui.WS.FlightRecorder.BudgetMB"),
+	16,
+	TEXT("Memory budget of the flight recorder in MB, applied when it is enabled")
+};
+TAutoConsoleVariable<float> CVar_FlightRecorderHitchMs
+{
+	TEXT("ImGui.WS.FlightRecorder.HitchMs"),
+	250.f,
+	TEXT("Frame time in ms above which the flight recorder is dumped, 0 disables")
+};
+FAutoConsoleCommand DumpFlightRecorder
+{
+	TEXT("ImGui.WS.DumpFlightRecorder"),
+	TEXT("Dump the ImGui-WS flight recorder to ImGui.WS.RecordDirPath"),
+	FConsoleCommandDelegate::CreateLambda([]
+	{
+		UImGui_WS_Manager* Manager = UImGui_WS_Manager::GetChecked();
+		if (Manager->IsEnable())
+		{
+			Manager->DumpFlightRecorder(TEXT("Command"));
+		}
+	})
+};
+
 #if PLATFORM_WINDOWS
 #include <corecrt_io.h>
 #endif
@@ -173,11 +214,24 @@ public:
 	TSharedPtr<ImGuiWS_Record::Session, ESPMode::ThreadSafe> RecordSession;
 	TUniquePtr<ImGuiWS_Record::FImGuiWS_Replay> RecordReplay;
 
+	// only used by the WS thread
+	TUniquePtr<ImGuiWS_Record::FlightRecorder> FlightRecorder;
+	// dump requests, written out once the frames after the trigger are captured too
+	FCriticalSection FlightRecorderDumpCriticalSection;
+	FString FlightRecorderDumpPath;
+	double FlightRecorderDumpTime = 0.0;
+	double LastFlightRecorderTriggerTime = -UE_BIG_NUMBER;
+	bool bFlightRecorderOverBudgetWarned = false;
+	FDelegateHandle OnHandleSystemEnsureHandle;
+	FDelegateHandle OnWakeUpHandle;
+
 	struct EServerEventType
 	{
 		enum Type : int32
 		{
-			SetClipboardText
+			SetClipboardText,
+			// sent by ImGuiWS::RemoveTexture
+			RemoveTexture,
 		};
 	};
 
@@ -258,7 +312,30 @@ public:
 				FFileHelper::SaveArrayToFile(Bin, *FilePath);
 			}
 		}
-		ImGuiWS.Init(Manager.GetPort(), HtmlPath);
+		const FImGuiWSCompressionSettings& CompressionSettings = Manager.GetCompressionSettings();
+		ImGuiWS::FCompression Compression;
+		Compression.DeflateLevel = CompressionSettings.bPerMessageDeflate ? CompressionSettings.DeflateLevel : 0;
+		Compression.bLZ4Frame = CompressionSettings.bLZ4Frame;
+		Compression.MinCompressMessageSize = CompressionSettings.MinCompressMessageSize;
+		ImGuiWS.Init(Manager.GetPort(), HtmlPath, Compression);
+		ImGuiWS.SetDrawDataKeyframeInterval(GetDefault<UImGuiSettings>()->DrawDataKeyframeInterval);
+		ImGuiWS.SetTextureMaxDirtyRatio(GetDefault<UImGuiSettings>()->TextureMaxDirtyRatio);
+		ImGuiWS::FTextureCompression TextureCompression;
+		TextureCompression.bLossless = GetDefault<UImGuiSettings>()->bLosslessTextureEncoding;
+		TextureCompression.LossyQuality = GetDefault<UImGuiSettings>()->TextureLossyQuality;
+		ImGuiWS.SetTextureCompression(TextureCompression);
+		ImGuiWS.SetTextureHandler([this](ImGuiWS::FTextureId TextureId, const ImGuiWS::FTexture& Texture)
+		{
+			if (FlightRecorder.IsValid())
+			{
+				RecordTexture(*FlightRecorder, TextureId, Texture);
+			}
+			if (const auto RecordSessionKeeper = RecordSession)
+			{
+				FScopeLock ScopeLock{ &RecordCriticalSection };
+				RecordTexture(*RecordSessionKeeper, TextureId, Texture);
+			}
+		});
 		WS_Thread = FThread{ TEXT("ImGui_WS"), [this, Interval = GetDefault<UImGuiSettings>()->ServerTickInterval]
 		{
 #if PLATFORM_WINDOWS
@@ -267,15 +344,13 @@ public:
 				std::setlocale(LC_ALL, "en_US.UTF-8");
 			}
 #endif
+			// the thread sleeps inside lws_service, it wakes up on socket activity or when the game thread hands over new data
+			const int32 IntervalMs = FMath::Max(FMath::CeilToInt32(Interval * 1000.f), 1);
 			while (bRequestedExit == false)
 			{
-				const double StartSeconds = FPlatformTime::Seconds();
-				WS_ThreadUpdate();
-				const double SleepSeconds = Interval - (FPlatformTime::Seconds() - StartSeconds);
-				if (SleepSeconds > 0.f)
-				{
-					FPlatformProcess::SleepNoStats(SleepSeconds);
-				}
+				// nothing to send without connections or recording, park until a client connects
+				const bool bIdle = ImGuiWS.NumConnected() == 0 && RecordSession.IsValid() == false && CVar_FlightRecorder.GetValueOnAnyThread() == false && ImGuiDataTripleBuffer.IsDirty() == false;
+				WS_ThreadUpdate(bIdle ? MAX_int32 : IntervalMs);
 			}
 		}, 0, TPri_Lowest };
 
@@ -296,17 +371,31 @@ public:
 			static_assert((int32_t)ImGuiWS::FTexture::Type::RGBA32 == (uint8)ETextureFormat::RGBA8);
 			ImGuiWS.SetTexture(Handle, ImGuiWS::FTexture::Type{ static_cast<uint8>(TextureFormat) }, Width, Height, Data);
 		};
+		Private::RemoveTextureData_WS = [this](uint32 Handle)
+		{
+			ImGuiWS.RemoveTexture(Handle);
+		};
+
+		OnHandleSystemEnsureHandle = FCoreDelegates::OnHandleSystemEnsure.AddRaw(this, &FImpl::OnHandleSystemEnsure);
+		OnWakeUpHandle = FImGuiDelegates::OnImGui_WS_WakeUp.AddLambda([this]
+		{
+			Idle.bWakeUpRequested = true;
+		});
 
 		FImGuiDelegates::OnImGui_WS_Enable.Broadcast();
 	}
 	~FImpl() override
 	{
+		FCoreDelegates::OnHandleSystemEnsure.Remove(OnHandleSystemEnsureHandle);
+		FImGuiDelegates::OnImGui_WS_WakeUp.Remove(OnWakeUpHandle);
 		FImGuiDelegates::OnImGui_WS_Disable.Broadcast();
 		FImGuiDelegates::OnImGuiContextDestroyed.Broadcast(Context);
 		ImGui::DestroyContext(Context);
 		ImPlot::DestroyContext(PlotContext);
 		UnrealImGui::Private::UpdateTextureData_WS.Reset();
+		UnrealImGui::Private::RemoveTextureData_WS.Reset();
 		bRequestedExit = true;
+		ImGuiWS.WakeUp();
 		if (WS_Thread.IsJoinable())
 		{
 			WS_Thread.Join();
@@ -529,6 +618,14 @@ public:
 		    				IO.AddInputCharactersUTF8(Event.InputtedText.c_str());
 		    			}
 		    			break;
+		    		case ImGuiWS::FEvent::ReplayControl:
+		    			{
+		    				if (Owner.RecordReplay.IsValid())
+		    				{
+		    					Owner.RecordReplay->HandleControl(Event.ReplayCommand, Event.ReplayFrame);
+		    				}
+		    			}
+		    			break;
 		            default:
 		            	ensureMsgf(false, TEXT("Unhandle input event %d"), Event.Type);
 		            }
@@ -541,6 +638,69 @@ public:
 	FVSync VSync;
 	FState State;
 
+	// unchanged frames without input drop the UI to a low rate, so an idle browser tab costs next to nothing
+	struct FIdle
+	{
+		int32 FrameThreshold = GetDefault<UImGuiSettings>()->IdleFrameThreshold;
+		float TickRate = GetDefault<UImGuiSettings>()->IdleTickRate;
+
+		int32 NumIdleFrames = 0;
+		double LastFrameTime = 0.0;
+		uint64 LastFrameHash = 0;
+		bool bWakeUpRequested = false;
+
+		bool ShouldSkipFrame(bool bActive)
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (bActive || bWakeUpRequested)
+			{
+				bWakeUpRequested = false;
+				NumIdleFrames = 0;
+			}
+			else if (TickRate > 0.f && NumIdleFrames >= FrameThreshold && Now - LastFrameTime < 1.0 / TickRate)
+			{
+				return true;
+			}
+			LastFrameTime = Now;
+			return false;
+		}
+
+		// returns whether the frame differs from the previous one
+		bool EndFrame(const ImDrawData* DrawData, const ImGuiWS::FDrawInfo& DrawInfo)
+		{
+			FXxHash64Builder Builder;
+			Builder.Update(&DrawData->DisplayPos, sizeof(DrawData->DisplayPos));
+			Builder.Update(&DrawData->DisplaySize, sizeof(DrawData->DisplaySize));
+			for (int32 Idx = 0; Idx < DrawData->CmdListsCount; ++Idx)
+			{
+				const ImDrawList* CmdList = DrawData->CmdLists[Idx];
+				Builder.Update(CmdList->VtxBuffer.Data, CmdList->VtxBuffer.Size * sizeof(ImDrawVert));
+				Builder.Update(CmdList->IdxBuffer.Data, CmdList->IdxBuffer.Size * sizeof(ImDrawIdx));
+				for (const ImDrawCmd& Cmd : CmdList->CmdBuffer)
+				{
+					Builder.Update(&Cmd.ClipRect, sizeof(Cmd.ClipRect));
+					Builder.Update(&Cmd.TextureId, sizeof(Cmd.TextureId));
+					Builder.Update(&Cmd.VtxOffset, sizeof(Cmd.VtxOffset));
+					Builder.Update(&Cmd.IdxOffset, sizeof(Cmd.IdxOffset));
+					Builder.Update(&Cmd.ElemCount, sizeof(Cmd.ElemCount));
+				}
+			}
+			Builder.Update(&DrawInfo.MouseCursor, sizeof(DrawInfo.MouseCursor));
+			Builder.Update(&DrawInfo.ControlId, sizeof(DrawInfo.ControlId));
+			Builder.Update(&DrawInfo.MousePos, sizeof(DrawInfo.MousePos));
+			Builder.Update(&DrawInfo.ViewportSize, sizeof(DrawInfo.ViewportSize));
+			Builder.Update(&DrawInfo.bWantTextInput, sizeof(DrawInfo.bWantTextInput));
+			Builder.Update(&DrawInfo.ImeInputPos, sizeof(DrawInfo.ImeInputPos));
+			const uint64 FrameHash = Builder.Finalize().Hash;
+
+			const bool bChanged = FrameHash != LastFrameHash;
+			LastFrameHash = FrameHash;
+			NumIdleFrames = bChanged ? 0 : NumIdleFrames + 1;
+			return bChanged;
+		}
+	};
+	FIdle Idle;
+
 	bool IsTickableWhenPaused() const override { return true; }
 	bool IsTickableInEditor() const override { return true; }
 	TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(UImGui_WS_Manager_FDrawer, STATGROUP_Tickables); }
@@ -550,8 +710,10 @@ public:
 	{
 		ImDrawData CopiedDrawData;
 		const ImGuiWS::FDrawInfo DrawInfo;
+		const double CaptureTime = FPlatformTime::Seconds();
+		TArray<ImGuiWS::FEvent> RecordedEvents;
 
-		FImGuiData(const ImDrawData* DrawData, ImGuiWS_Record::FImGuiWS_Replay* Replay, const ImGuiWS::FDrawInfo&& DrawInfo)
+		FImGuiData(const ImDrawData* DrawData, ImGuiWS_Record::FImGuiWS_Replay* Replay, const ImGuiWS::FDrawInfo& DrawInfo)
 			: CopiedDrawData{ *DrawData }
 			, DrawInfo{ DrawInfo }
 		{
@@ -590,11 +752,25 @@ public:
 
 	void Tick(float DeltaTime) override
 	{
-		if (ImGuiWS.NumConnected() == 0 && RecordSession.IsValid() == false)
+		// the flight recorder keeps frames and catches hitches whether a browser is connected or not
+		const bool bFlightRecorder = CVar_FlightRecorder.GetValueOnGameThread();
+		const float HitchMs = CVar_FlightRecorderHitchMs.GetValueOnGameThread();
+		if (bFlightRecorder && HitchMs > 0.f && FApp::GetDeltaTime() * 1000.0 > HitchMs)
+		{
+			RequestFlightRecorderDump(TEXT("Hitch"), true);
+		}
+
+		if (ImGuiWS.NumConnected() == 0 && RecordSession.IsValid() == false && bFlightRecorder == false)
 		{
 	        return;
 	    }
 
+		// replays advance with the engine delta time, skipped frames would slow them down
+		if (Idle.ShouldSkipFrame(ImGuiWS.TakeEvents().IsEmpty() == false || RecordReplay.IsValid()))
+		{
+			return;
+		}
+
 		DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Tick"), STAT_ImGuiWS_Tick, STATGROUP_ImGui);
 
 	    ImGuiContext* OldContent = ImGui::GetCurrentContext();
@@ -617,6 +793,12 @@ public:
 			Events.Dequeue(Event);
 	        State.Handle(Event);
 		}
+		// input of the controlling client is kept for the recording before Update consumes it
+		TArray<ImGuiWS::FEvent> RecordedEvents;
+		if ((RecordSession.IsValid() || CVar_FlightRecorder.GetValueOnGameThread()) && State.CurControlId > 0)
+		{
+			RecordedEvents.Append(State.PendingEvents);
+		}
 	    State.Update(*this);
 
 	    ImGuiIO& IO = ImGui::GetIO();
@@ -838,18 +1020,28 @@ public:
 			// generate ImDrawData
 			ImGui::Render();
 			const ImDrawData* DrawData = ImGui::GetDrawData();
+			UnrealImGui::TouchTextures(DrawData);
 
 			const auto CurControlIp = State.Clients.FindRef(State.CurControlId).Ip;
-			ImGuiDataTripleBuffer.WriteAndSwap(MakeShared<FImGuiData>(DrawData, RecordReplay.Get(),
-				ImGuiWS::FDrawInfo{
-					ImGui::GetMouseCursor(),
-					State.CurControlId,
-					CurControlIp,
-					FVector2f{ ImGui::GetMousePos() },
-					FVector2f{ IO.DisplaySize },
-					IO.WantTextInput,
-					IO.WantTextInput ? FVector2f{ ImGui::GetCurrentContext()->PlatformImeData.InputPos } : FVector2f::ZeroVector
-				}));
+			const ImGuiWS::FDrawInfo DrawInfo{
+				ImGui::GetMouseCursor(),
+				State.CurControlId,
+				CurControlIp,
+				FVector2f{ ImGui::GetMousePos() },
+				FVector2f{ IO.DisplaySize },
+				IO.WantTextInput,
+				IO.WantTextInput ? FVector2f{ ImGui::GetCurrentContext()->PlatformImeData.InputPos } : FVector2f::ZeroVector
+			};
+			// the clients already have an identical frame, recordings and the flight recorder still get it for their timeline and input
+			// replays send their own draw data, which the hash doesn't cover
+			const bool bChanged = Idle.EndFrame(DrawData, DrawInfo);
+			if (bChanged || RecordReplay.IsValid() || RecordSession.IsValid() || bFlightRecorder || RecordedEvents.Num() > 0)
+			{
+				const TSharedPtr<FImGuiData> ImGuiData = MakeShared<FImGuiData>(DrawData, RecordReplay.Get(), DrawInfo);
+				ImGuiData->RecordedEvents = MoveTemp(RecordedEvents);
+				ImGuiDataTripleBuffer.WriteAndSwap(ImGuiData);
+				ImGuiWS.WakeUp();
+			}
 		}
 
 	    ImGui::EndFrame();
@@ -859,7 +1051,7 @@ public:
 			RecordReplay.Reset();
 		}
 	}
-	void WS_ThreadUpdate()
+	void WS_ThreadUpdate(int32 TimeoutMs)
 	{
 		if (ImGuiDataTripleBuffer.IsDirty())
 		{
@@ -870,31 +1062,192 @@ public:
 				ImGuiWS.SetDrawInfo(ImGuiData->DrawInfo);
 			}
 
+			UpdateFlightRecorder(*ImGuiData);
 			if (const auto RecordSessionKeeper = RecordSession)
 			{
 				DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Record_AddFrame"), STAT_ImGuiWS_Record_AddFrame, STATGROUP_ImGui);
+				const ImGuiWS_Record::FrameInfo RecordFrameInfo = MakeRecordFrameInfo(*ImGuiData);
 				FScopeLock ScopeLock{ &RecordCriticalSection };
-				RecordSessionKeeper->addFrame(&ImGuiData->CopiedDrawData);
+				if (RecordSessionKeeper->nFrames() == 0)
+				{
+					// textures uploaded before the recording started
+					ImGuiWS.ForEachTexture([&](ImGuiWS::FTextureId TextureId, const ImGuiWS::FTexture& Texture)
+					{
+						RecordTexture(*RecordSessionKeeper, TextureId, Texture);
+					});
+				}
+				RecordSessionKeeper->addFrame(&ImGuiData->CopiedDrawData, RecordFrameInfo);
 			}
 		}
-		ImGuiWS.Tick();
+		UpdateFlightRecorderDump();
+		ImGuiWS.Tick(TimeoutMs);
 	}
 
+	static ImGuiWS_Record::FrameInfo MakeRecordFrameInfo(const FImGuiData& ImGuiData)
+	{
+		ImGuiWS_Record::FrameInfo RecordFrameInfo;
+		RecordFrameInfo.time = ImGuiData.CaptureTime;
+		RecordFrameInfo.mousePos = ImVec2{ ImGuiData.DrawInfo.MousePos.X, ImGuiData.DrawInfo.MousePos.Y };
+		RecordFrameInfo.displaySize = ImVec2{ ImGuiData.DrawInfo.ViewportSize.X, ImGuiData.DrawInfo.ViewportSize.Y };
+		for (const ImGuiWS::FEvent& Event : ImGuiData.RecordedEvents)
+		{
+			ImGuiWS_Record::InputEvent& Input = RecordFrameInfo.inputs.emplace_back();
+			Input.type = Event.Type;
+			switch (Event.Type)
+			{
+			case ImGuiWS::FEvent::MouseMove:
+			case ImGuiWS::FEvent::MouseDown:
+			case ImGuiWS::FEvent::MouseUp:
+				Input.x = Event.MouseX;
+				Input.y = Event.MouseY;
+				Input.key = Event.MouseBtn;
+				break;
+			case ImGuiWS::FEvent::MouseWheel:
+				Input.x = Event.WheelX;
+				Input.y = Event.WheelY;
+				break;
+			case ImGuiWS::FEvent::Resize:
+				Input.x = Event.ClientWidth;
+				Input.y = Event.ClientHeight;
+				break;
+			case ImGuiWS::FEvent::PasteClipboard:
+				Input.text = Event.ClipboardText;
+				break;
+			case ImGuiWS::FEvent::InputText:
+				Input.text = Event.InputtedText;
+				break;
+			default:
+				Input.key = Event.Key;
+			}
+		}
+		return RecordFrameInfo;
+	}
+
+	template<typename TRecorder>
+	static void RecordTexture(TRecorder& Recorder, ImGuiWS::FTextureId TextureId, const ImGuiWS::FTexture& Texture)
+	{
+		const TArrayView<const uint8> Pixels = Texture.GetPixels();
+		Recorder.addTexture(TextureId, (int32)Texture.TextureType, Texture.Width, Texture.Height, Pixels.GetData(), Pixels.Num());
+	}
+
+	void UpdateFlightRecorder(const FImGuiData& ImGuiData)
+	{
+		const bool bEnable = CVar_FlightRecorder.GetValueOnAnyThread();
+		if (bEnable != FlightRecorder.IsValid())
+		{
+			if (bEnable)
+			{
+				const double MaxSeconds = FMath::Max(CVar_FlightRecorderSeconds.GetValueOnAnyThread(), 1.f);
+				const SIZE_T MaxBytes = FMath::Max(CVar_FlightRecorderBudgetMB.GetValueOnAnyThread(), 1) * 1024ull * 1024ull;
+				FlightRecorder = MakeUnique<ImGuiWS_Record::FlightRecorder>(MaxSeconds, MaxBytes);
+				bFlightRecorderOverBudgetWarned = false;
+				ImGuiWS.ForEachTexture([this](ImGuiWS::FTextureId TextureId, const ImGuiWS::FTexture& Texture)
+				{
+					RecordTexture(*FlightRecorder, TextureId, Texture);
+				});
+			}
+			else
+			{
+				FlightRecorder.Reset();
+			}
+		}
+		if (FlightRecorder.IsValid() == false)
+		{
+			return;
+		}
+
+		DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_FlightRecorder_AddFrame"), STAT_ImGuiWS_FlightRecorder_AddFrame, STATGROUP_ImGui);
+		FlightRecorder->addFrame(&ImGuiData.CopiedDrawData, MakeRecordFrameInfo(ImGuiData));
+		if (bFlightRecorderOverBudgetWarned == false && FlightRecorder->liveTextureSize_bytes() > FlightRecorder->maxSize_bytes())
+		{
+			bFlightRecorderOverBudgetWarned = true;
+			UE_LOG(LogImGui, Warning, TEXT("ImGui-WS flight recorder bound textures use %.1f MB, above ImGui.WS.FlightRecorder.BudgetMB, only the newest frames are kept"),
+				FlightRecorder->liveTextureSize_bytes() / (1024.0 * 1024.0));
+		}
+	}
+
+	// apart from the frames, so a requested dump isn't held back by a static UI
+	void UpdateFlightRecorderDump()
+	{
+		FString DumpPath;
+		{
+			FScopeLock ScopeLock{ &FlightRecorderDumpCriticalSection };
+			if (FlightRecorderDumpPath.IsEmpty() || FPlatformTime::Seconds() < FlightRecorderDumpTime)
+			{
+				return;
+			}
+			DumpPath = MoveTemp(FlightRecorderDumpPath);
+			FlightRecorderDumpPath.Reset();
+		}
+		if (FlightRecorder.IsValid() == false)
+		{
+			UE_LOG(LogImGui, Warning, TEXT("ImGui-WS flight recorder has no frames yet, nothing dumped to %s"), *DumpPath);
+			return;
+		}
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(DumpPath), true);
+		if (FlightRecorder->dump(TCHAR_TO_UTF8(*DumpPath)))
+		{
+			UE_LOG(LogImGui, Display, TEXT("ImGui-WS flight recorder dumped %d frames to %s"), FlightRecorder->nFrames(), *DumpPath);
+		}
+		else
+		{
+			UE_LOG(LogImGui, Warning, TEXT("ImGui-WS flight recorder dump failed: %s"), *DumpPath);
+		}
+	}
+
+	// thread safe, automatic triggers are rate limited so a burst of hitches or ensures dumps once
+	void RequestFlightRecorderDump(const TCHAR* Reason, bool bAutomatic)
+	{
+		constexpr double PostTriggerSeconds = 1.0;
+		constexpr double AutomaticTriggerCooldownSeconds = 30.0;
+
+		const double Now = FPlatformTime::Seconds();
+		FScopeLock ScopeLock{ &FlightRecorderDumpCriticalSection };
+		if (FlightRecorderDumpPath.IsEmpty() == false || (bAutomatic && Now - LastFlightRecorderTriggerTime < AutomaticTriggerCooldownSeconds))
+		{
+			return;
+		}
+		LastFlightRecorderTriggerTime = Now;
+		FlightRecorderDumpPath = FString::Printf(TEXT("%s/FlightRecorder_%s_%s.imgrcd"), *GRecordSaveDirPathString, *FDateTime::Now().ToString(), Reason);
+		FlightRecorderDumpTime = bAutomatic ? Now + PostTriggerSeconds : Now;
+		ImGuiWS.WakeUp();
+	}
+
+	void OnHandleSystemEnsure()
+	{
+		if (CVar_FlightRecorder.GetValueOnAnyThread())
+		{
+			RequestFlightRecorderDump(TEXT("Ensure"), true);
+		}
+	}
+
+	FString RecordSavePath;
 	void StartRecord()
 	{
-		// TODO：stream save
-		RecordSession = MakeShared<ImGuiWS_Record::Session>();
+		// frames are streamed to disk by a background writer while recording
+		IFileManager::Get().MakeDirectory(*GRecordSaveDirPathString, true);
+		RecordSavePath = FString::Printf(TEXT("%s/%s.imgrcd"), *GRecordSaveDirPathString, *FDateTime::Now().ToString());
+		const auto NewSession = MakeShared<ImGuiWS_Record::Session, ESPMode::ThreadSafe>();
+		if (NewSession->beginStream(TCHAR_TO_UTF8(*RecordSavePath)) == false)
+		{
+			ImGui::InsertNotification(ImGuiToastType_Error, "Can't Create Record File:\n%s", TCHAR_TO_UTF8(*RecordSavePath));
+			return;
+		}
+		RecordSession = NewSession;
 	}
 	void StopRecord()
 	{
 		check(RecordSession.IsValid());
 		FScopeLock ScopeLock{ &RecordCriticalSection };
-		const FString SavePath = FString::Printf(TEXT("%s/%s.imgrcd"), *GRecordSaveDirPathString, *FDateTime::Now().ToString());
-		if (RecordSession->save(TCHAR_TO_UTF8(*SavePath)))
+		const bool bSaved = RecordSession->endStream();
+		RecordSession.Reset();
+		if (bSaved)
 		{
-			RecordSession.Reset();
-
-			ImGui::InsertNotification(ImGuiToastType_Success, "Save Record To:\n%s", TCHAR_TO_UTF8(*SavePath));
+			ImGui::InsertNotification(ImGuiToastType_Success, "Save Record To:\n%s", TCHAR_TO_UTF8(*RecordSavePath));
+		}
+		else
+		{
+			ImGui::InsertNotification(ImGuiToastType_Error, "Save Record Failed:\n%s", TCHAR_TO_UTF8(*RecordSavePath));
 		}
 	}
 };
@@ -975,6 +1328,20 @@ int32 UImGui_WS_Manager::GetPort() const
 	return Settings->GamePort;
 }
 
+const FImGuiWSCompressionSettings& UImGui_WS_Manager::GetCompressionSettings() const
+{
+	const UImGuiSettings* Settings = GetDefault<UImGuiSettings>();
+	if (GIsEditor)
+	{
+		return Settings->EditorCompression;
+	}
+	if (GIsServer)
+	{
+		return Settings->ServerCompression;
+	}
+	return Settings->GameCompression;
+}
+
 int32 UImGui_WS_Manager::GetConnectionCount() const
 {
 	return Impl ? Impl->ImGuiWS.NumConnected() : 0;
@@ -993,6 +1360,20 @@ void UImGui_WS_Manager::OpenWebPage(bool bServerPort) const
 	}
 }
 
+void UImGui_WS_Manager::DumpFlightRecorder(const FString& Reason)
+{
+	if (Impl == nullptr)
+	{
+		return;
+	}
+	if (CVar_FlightRecorder.GetValueOnGameThread() == false)
+	{
+		UE_LOG(LogImGui, Warning, TEXT("ImGui-WS flight recorder is disabled, enable it with ImGui.WS.FlightRecorder 1"));
+		return;
+	}
+	Impl->RequestFlightRecorderDump(*Reason, false);
+}
+
 bool UImGui_WS_Manager::IsRecording() const
 {
 	if (Impl && Impl->RecordSession)
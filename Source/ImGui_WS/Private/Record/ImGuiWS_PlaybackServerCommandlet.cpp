@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImGuiWS_PlaybackServerCommandlet.h"
+
+#include "imgui-ws.h"
+#include "imgui.h"
+#include "ImGuiFontAtlas.h"
+#include "ImGuiWS_Replay.h"
+#include "UnrealImGuiStyles.h"
+#include "UnrealImGuiTexture.h"
+#include "WebKeyCodeToImGui.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogImGuiWSPlaybackServer, Log, All);
+
+namespace ImGuiWS_Record
+{
+	// replay state published to the clients as incppect vars
+	struct FPlaybackState
+	{
+		int32 Frame = 0;
+		int32 NumFrames = 0;
+		double Time = 0.0;
+		uint8 bPlaying = 0;
+
+		void Update(const FImGuiWS_Replay& Replay)
+		{
+			Frame = Replay.GetFrameIndex();
+			NumFrames = Replay.GetNumFrames();
+			Time = Replay.GetPlayTime();
+			bPlaying = Replay.IsPlaying();
+		}
+	};
+
+	// the first client controls the replay until another one takes over, like the live server
+	// besides the control bar it can send ReplayControl messages to play, pause and seek
+	struct FPlaybackInput
+	{
+		TArray<int32> Clients;
+		int32 ControlId = INDEX_NONE;
+
+		void Handle(const ImGuiWS::FEvent& Event, ImGuiIO& IO, FImGuiWS_Replay& Replay)
+		{
+			static auto ConvertWebMouseButtonToImGui = [](int32 WebMouseButton)
+			{
+				return WebMouseButton == 1 ? 2 : WebMouseButton == 2 ? 1 : WebMouseButton;
+			};
+
+			switch (Event.Type)
+			{
+			case ImGuiWS::FEvent::Connected:
+				Clients.Add(Event.ClientId);
+				break;
+			case ImGuiWS::FEvent::Disconnected:
+				Clients.Remove(Event.ClientId);
+				break;
+			case ImGuiWS::FEvent::TakeControl:
+				if (Clients.Contains(Event.ClientId))
+				{
+					ControlId = Event.ClientId;
+					IO.ClearInputKeys();
+				}
+				break;
+			default:
+				break;
+			}
+			if (Clients.Contains(ControlId) == false)
+			{
+				ControlId = Clients.Num() > 0 ? Clients[0] : INDEX_NONE;
+				IO.ClearInputKeys();
+			}
+			if (Event.ClientId != ControlId)
+			{
+				return;
+			}
+
+			switch (Event.Type)
+			{
+			case ImGuiWS::FEvent::MouseMove:
+				IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
+				break;
+			case ImGuiWS::FEvent::MouseDown:
+			case ImGuiWS::FEvent::MouseUp:
+				IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
+				IO.AddMouseButtonEvent(ConvertWebMouseButtonToImGui(Event.MouseBtn), Event.Type == ImGuiWS::FEvent::MouseDown);
+				break;
+			case ImGuiWS::FEvent::MouseWheel:
+				IO.AddMouseWheelEvent(Event.WheelX, Event.WheelY);
+				break;
+			case ImGuiWS::FEvent::KeyDown:
+			case ImGuiWS::FEvent::KeyUp:
+				IO.AddKeyEvent(ToImGuiKey(EWebKeyCode(Event.Key)), Event.Type == ImGuiWS::FEvent::KeyDown);
+				break;
+			case ImGuiWS::FEvent::Resize:
+				IO.DisplaySize = { (float)Event.ClientWidth, (float)Event.ClientHeight };
+				break;
+			case ImGuiWS::FEvent::ReplayControl:
+				Replay.HandleControl(Event.ReplayCommand, Event.ReplayFrame);
+				break;
+			default:
+				break;
+			}
+		}
+	};
+}
+
+UImGuiWSPlaybackServerCommandlet::UImGuiWSPlaybackServerCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UImGuiWSPlaybackServerCommandlet::Main(const FString& Params)
+{
+	using namespace ImGuiWS_Record;
+
+	FString InputPath;
+	if (FParse::Value(*Params, TEXT("Input="), InputPath) == false)
+	{
+		UE_LOG(LogImGuiWSPlaybackServer, Error, TEXT("Usage: -run=ImGuiWSPlaybackServer -Input=<file.imgrcd> [-Port=8890] [-Fps=60]"));
+		return 1;
+	}
+	int32 Port = 8890;
+	float Fps = 60.f;
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("Fps="), Fps);
+	const double FrameInterval = 1.0 / FMath::Clamp(Fps, 1.f, 240.f);
+
+	const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT(UE_PLUGIN_NAME));
+	const FString HtmlPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*FPaths::ConvertRelativePathToFull(Plugin->GetBaseDir() / TEXT("Resources/HTML")));
+
+	ImGuiContext* PrevContext = ImGui::GetCurrentContext();
+	ImGuiContext* Context = ImGui::CreateContext(&UnrealImGui::GetDefaultFontAtlas());
+	ImGui::SetCurrentContext(Context);
+	ON_SCOPE_EXIT
+	{
+		UnrealImGui::Private::UpdateTextureData_WS.Reset();
+		ImGui::DestroyContext(Context);
+		ImGui::SetCurrentContext(PrevContext);
+	};
+	ImGuiIO& IO = ImGui::GetIO();
+	IO.IniFilename = nullptr;
+	IO.DisplaySize = ImVec2(1920, 1080);
+	UnrealImGui::DefaultStyle();
+	ImGui::GetStyle().AntiAliasedFill = false;
+	ImGui::GetStyle().AntiAliasedLines = false;
+
+	FImGuiWS_Replay Replay{ TCHAR_TO_UTF8(*InputPath) };
+	if (Replay.GetNumFrames() == 0)
+	{
+		UE_LOG(LogImGuiWSPlaybackServer, Error, TEXT("Failed to load %s"), *InputPath);
+		return 1;
+	}
+
+	ImGuiWS Server;
+	if (Server.Init(Port, HtmlPath) == false)
+	{
+		UE_LOG(LogImGuiWSPlaybackServer, Error, TEXT("Failed to listen on port %d"), Port);
+		return 1;
+	}
+	{
+		unsigned char* Pixels;
+		int32 Width, Height;
+		IO.Fonts->GetTexDataAsAlpha8(&Pixels, &Width, &Height);
+		Server.SetTexture(0, ImGuiWS::FTexture::Type::Alpha8, Width, Height, Pixels);
+	}
+	// recorded textures are uploaded by the replay under their own handles
+	UnrealImGui::Private::UpdateTextureData_WS = [&Server](FImGuiTextureHandle Handle, UnrealImGui::ETextureFormat TextureFormat, int32 Width, int32 Height, const uint8* Data)
+	{
+		Server.SetTexture(Handle, ImGuiWS::FTexture::Type{ static_cast<uint8>(TextureFormat) }, Width, Height, Data);
+	};
+
+	FPlaybackState PlaybackState;
+	Server.AddVar(TEXT("replay.frame"), [&PlaybackState](const auto&) { return FIncppect::view(PlaybackState.Frame); });
+	Server.AddVar(TEXT("replay.n_frames"), [&PlaybackState](const auto&) { return FIncppect::view(PlaybackState.NumFrames); });
+	Server.AddVar(TEXT("replay.time"), [&PlaybackState](const auto&) { return FIncppect::view(PlaybackState.Time); });
+	Server.AddVar(TEXT("replay.playing"), [&PlaybackState](const auto&) { return FIncppect::view(PlaybackState.bPlaying); });
+
+	UE_LOG(LogImGuiWSPlaybackServer, Display, TEXT("Serving %s (%d frames) on http://localhost:%d"), *InputPath, Replay.GetNumFrames(), Port);
+
+	FPlaybackInput Input;
+	bool bQuit = false;
+	double LastTime = FPlatformTime::Seconds();
+	while (bQuit == false && IsEngineExitRequested() == false)
+	{
+		const double Now = FPlatformTime::Seconds();
+		const float DeltaTime = FMath::Max((float)(Now - LastTime), 1e-4f);
+		LastTime = Now;
+
+		IO.DeltaTime = DeltaTime;
+		auto& Events = Server.TakeEvents();
+		ImGuiWS::FEvent Event;
+		while (Events.Dequeue(Event))
+		{
+			Input.Handle(Event, IO, Replay);
+		}
+
+		// nobody to stream to, keep the replay where it is
+		if (Input.Clients.Num() == 0)
+		{
+			Server.Tick(MAX_int32);
+			LastTime = FPlatformTime::Seconds();
+			continue;
+		}
+
+		ImGui::NewFrame();
+		Replay.Draw(DeltaTime, bQuit);
+		ImGui::Render();
+
+		ImGuiWS_Record::FImGuiWS_Replay::FDrawData ReplayDrawData;
+		ImDrawData* UIDrawData = ImGui::GetDrawData();
+		ImDrawData DrawData{ *UIDrawData };
+		if (Replay.GetDrawData(ReplayDrawData))
+		{
+			// the recorded frame goes below the control bar
+			DrawData.CmdLists.resize(0);
+			for (int32 Idx = 0; Idx < ReplayDrawData->CmdListsCount; ++Idx)
+			{
+				DrawData.CmdLists.push_back(ReplayDrawData->CmdLists[Idx]);
+			}
+			for (int32 Idx = 0; Idx < UIDrawData->CmdListsCount; ++Idx)
+			{
+				DrawData.CmdLists.push_back(UIDrawData->CmdLists[Idx]);
+			}
+			DrawData.CmdListsCount = DrawData.CmdLists.Size;
+		}
+		Server.SetDrawData(&DrawData);
+		Server.SetDrawInfo(ImGuiWS::FDrawInfo{
+			ImGui::GetMouseCursor(),
+			Input.ControlId,
+			0,
+			FVector2f{ ImGui::GetMousePos() },
+			FVector2f{ IO.DisplaySize },
+			0,
+			FVector2f::ZeroVector
+		});
+		PlaybackState.Update(Replay);
+
+		const double Elapsed = FPlatformTime::Seconds() - Now;
+		Server.Tick(FMath::Max(FMath::CeilToInt32((FrameInterval - Elapsed) * 1000.0), 0));
+	}
+
+	UE_LOG(LogImGuiWSPlaybackServer, Display, TEXT("Playback server stopped"));
+	return 0;
+}
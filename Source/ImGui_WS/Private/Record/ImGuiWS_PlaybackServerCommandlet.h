@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ImGuiWS_PlaybackServerCommandlet.generated.h"
+
+/**
+ * Serves an ImGui-WS recording to browsers without the game, the replay control bar handles play, pause and seek
+ * UnrealEditor-Cmd <Project> -run=ImGuiWSPlaybackServer -Input=<file.imgrcd> [-Port=8890] [-Fps=60] -nullrhi
+ */
+UCLASS()
+class UImGuiWSPlaybackServerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UImGuiWSPlaybackServerCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImGuiWS_RenderRecordCommandlet.h"
+
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "imgui-ws-rasterizer.h"
+#include "imgui_internal.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogImGuiWSRenderRecord, Log, All);
+
+UImGuiWSRenderRecordCommandlet::UImGuiWSRenderRecordCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UImGuiWSRenderRecordCommandlet::Main(const FString& Params)
+{
+	using namespace ImGuiWS_Record;
+
+	FString InputPath;
+	if (FParse::Value(*Params, TEXT("Input="), InputPath) == false)
+	{
+		UE_LOG(LogImGuiWSRenderRecord, Error, TEXT("Usage: -run=ImGuiWSRenderRecord -Input=<file.imgrcd> [-Output=<dir>] [-Start=0] [-Count=-1] [-Step=1]"));
+		return 1;
+	}
+	FString OutputDir = FPaths::Combine(FPaths::GetPath(InputPath), FPaths::GetBaseFilename(InputPath));
+	FParse::Value(*Params, TEXT("Output="), OutputDir);
+	int32 Start = 0;
+	int32 Count = -1;
+	int32 Step = 1;
+	FParse::Value(*Params, TEXT("Start="), Start);
+	FParse::Value(*Params, TEXT("Count="), Count);
+	FParse::Value(*Params, TEXT("Step="), Step);
+	Step = FMath::Max(Step, 1);
+
+	Session LoadedSession;
+	if (LoadedSession.load(TCHAR_TO_UTF8(*InputPath)) == false)
+	{
+		UE_LOG(LogImGuiWSRenderRecord, Error, TEXT("Failed to load %s"), *InputPath);
+		return 1;
+	}
+	const int32 NumFrames = LoadedSession.nFrames();
+	const int32 EndFrame = Count < 0 ? NumFrames : FMath::Min(NumFrames, Start + Count * Step);
+	if (LoadedSession.hasFrameInfo() == false)
+	{
+		UE_LOG(LogImGuiWSRenderRecord, Warning, TEXT("%s has no frame info, textures are not available and only vertex colors are drawn"), *InputPath);
+	}
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+	const TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+
+	// the replayed draw lists only need the shared data for their constructor, no ImGui context is required
+	ImDrawListSharedData SharedData;
+	ImDrawData DrawData;
+	std::vector<ImDrawList> DrawLists;
+	// decoded textures by content hash, unchanged textures are shared by most of the frames
+	TMap<uint64, TSharedPtr<TextureData>> Textures;
+	TMap<uint32, uint64> BoundTextures;
+	Rasterizer FrameRasterizer;
+	Image Target;
+
+	int32 NumWritten = 0;
+	for (int32 FrameIdx = FMath::Max(Start, 0); FrameIdx < EndFrame; FrameIdx += Step)
+	{
+		FrameInfo Info;
+		if (LoadedSession.getFrame(FrameIdx, &DrawData, DrawLists, &SharedData, &Info) == false)
+		{
+			UE_LOG(LogImGuiWSRenderRecord, Warning, TEXT("Failed to decode frame %d"), FrameIdx);
+			continue;
+		}
+
+		BoundTextures.Reset();
+		for (const TextureRef& Ref : Info.textures)
+		{
+			BoundTextures.Add(Ref.id, Ref.hash);
+			if (Textures.Contains(Ref.hash) == false)
+			{
+				TSharedPtr<TextureData> Texture = MakeShared<TextureData>();
+				Textures.Add(Ref.hash, LoadedSession.getTexture(Ref.hash, *Texture) ? Texture : nullptr);
+			}
+		}
+
+		const int32 Width = FMath::Max(FMath::RoundToInt32(DrawData.DisplaySize.x * DrawData.FramebufferScale.x), 1);
+		const int32 Height = FMath::Max(FMath::RoundToInt32(DrawData.DisplaySize.y * DrawData.FramebufferScale.y), 1);
+		Target.resize(Width, Height, IM_COL32(0, 0, 0, 255));
+		FrameRasterizer.render(&DrawData, [&](ImTextureID TextureId) -> const TextureData*
+		{
+			const uint64* Hash = BoundTextures.Find((uint32)TextureId);
+			const TSharedPtr<TextureData>* Texture = Hash ? Textures.Find(*Hash) : nullptr;
+			return Texture ? Texture->Get() : nullptr;
+		}, Target);
+
+		if (ImageWrapper->SetRaw(Target.pixels.data(), Target.pixels.size(), Width, Height, ERGBFormat::RGBA, 8) == false)
+		{
+			UE_LOG(LogImGuiWSRenderRecord, Error, TEXT("Failed to encode frame %d"), FrameIdx);
+			return 1;
+		}
+		const FString FramePath = FPaths::Combine(OutputDir, FString::Printf(TEXT("Frame_%06d.png"), FrameIdx));
+		if (FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *FramePath) == false)
+		{
+			UE_LOG(LogImGuiWSRenderRecord, Error, TEXT("Failed to write %s"), *FramePath);
+			return 1;
+		}
+		NumWritten += 1;
+	}
+
+	UE_LOG(LogImGuiWSRenderRecord, Display, TEXT("Rendered %d frames of %s to %s"), NumWritten, *InputPath, *OutputDir);
+	return 0;
+}
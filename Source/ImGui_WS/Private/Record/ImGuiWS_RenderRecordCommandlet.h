@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ImGuiWS_RenderRecordCommandlet.generated.h"
+
+/**
+ * Renders an ImGui-WS recording to a PNG sequence without a GPU
+ * UnrealEditor-Cmd <Project> -run=ImGuiWSRenderRecord -Input=<file.imgrcd> [-Output=<dir>] [-Start=0] [-Count=-1] [-Step=1]
+ */
+UCLASS()
+class UImGuiWSRenderRecordCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UImGuiWSRenderRecordCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
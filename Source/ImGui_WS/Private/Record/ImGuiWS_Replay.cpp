@@ -5,19 +5,104 @@
 
 #include "IconsFontAwesome.h"
 #include "imgui.h"
+#include "imgui-ws.h"
+#include "UnrealImGui_Log.h"
 
 namespace ImGuiWS_Record
 {
 FImGuiWS_Replay::FImGuiWS_Replay(const char* FilePath)
 {
 	LoadedSession.load(FilePath);
+	const int32 NumFrames = LoadedSession.nFrames();
+	FrameInfo LastFrameInfo;
+	FrameInfo PrevFrameInfo;
+	if (NumFrames > 1 && LoadedSession.getFrameInfo(NumFrames - 1, LastFrameInfo) && LoadedSession.getFrameInfo(NumFrames - 2, PrevFrameInfo))
+	{
+		LastFrameDuration = FMath::Max(LastFrameInfo.time - PrevFrameInfo.time, 0.0);
+	}
+	SeekFrame(0);
+}
+
+FImGuiWS_Replay::~FImGuiWS_Replay()
+{
+	for (const auto& [_, ReplayTexture] : ReplayTextures)
+	{
+		UnrealImGui::ReleaseTexture(ReplayTexture.Handle);
+	}
+}
+
+void FImGuiWS_Replay::SeekFrame(int32 Index)
+{
+	const int32 NumFrames = LoadedSession.nFrames();
+	FrameIndex = NumFrames > 0 ? FMath::Clamp(Index, 0, NumFrames - 1) : 0;
+	if (LoadedSession.getFrameInfo(FrameIndex, CurrentFrameInfo))
+	{
+		PlayTime = CurrentFrameInfo.time;
+	}
+}
+
+void FImGuiWS_Replay::AdvancePlayTime(float DeltaTime)
+{
+	const int32 NumFrames = LoadedSession.nFrames();
+	if (NumFrames == 0)
+	{
+		return;
+	}
+
+	PlayTime += DeltaTime * PlaySpeed;
+	FrameInfo NextFrameInfo;
+	while (true)
+	{
+		if (FrameIndex + 1 >= NumFrames)
+		{
+			// loop back to the start once the last frame was shown for its duration, taken from the interval before it
+			if (PlayTime >= CurrentFrameInfo.time + LastFrameDuration)
+			{
+				SeekFrame(0);
+			}
+			break;
+		}
+		if (LoadedSession.getFrameInfo(FrameIndex + 1, NextFrameInfo) == false || NextFrameInfo.time > PlayTime)
+		{
+			break;
+		}
+		FrameIndex += 1;
+		CurrentFrameInfo = MoveTemp(NextFrameInfo);
+	}
+}
+
+void FImGuiWS_Replay::HandleControl(int32 Command, int32 Frame)
+{
+	switch (Command)
+	{
+	case ImGuiWS::FEvent::ReplayPlay:
+		PlayState = EPlayState::Play;
+		break;
+	case ImGuiWS::FEvent::ReplayPause:
+		PlayState = EPlayState::Pause;
+		break;
+	case ImGuiWS::FEvent::ReplaySeek:
+		SeekFrame(Frame);
+		break;
+	default:
+		UE_LOG(LogImGui, Warning, TEXT("Unknown replay control command %d"), Command);
+		break;
+	}
 }
 
 void FImGuiWS_Replay::Draw(float DeltaTime, bool& CloseReplay)
 {
 	if (PlayState == EPlayState::Play)
 	{
-		FrameIndex = (FrameIndex + 1) % LoadedSession.nFrames();
+		AdvancePlayTime(DeltaTime);
+	}
+
+	// cursor of the client that had control while recording
+	if (LoadedSession.hasFrameInfo())
+	{
+		ImDrawList* ForegroundDrawList = ImGui::GetForegroundDrawList();
+		ForegroundDrawList->AddCircleFilled(CurrentFrameInfo.mousePos, 4.f, IM_COL32(255, 64, 64, 200));
+		ForegroundDrawList->AddCircle(CurrentFrameInfo.mousePos, 8.f, IM_COL32(255, 64, 64, 200), 0, 2.f);
 	}
 	
 	const ImVec2 MousePos = ImGui::GetMousePos();
@@ -43,6 +128,18 @@ void FImGuiWS_Replay::Draw(float DeltaTime, bool& CloseReplay)
 	{
 		ImGui::SetCursorPos({ 20.f, 10.f });
 		ImGui::Text("ImGui-WS Replay");
+		ImGui::SameLine();
+		if (LoadedSession.hasFrameInfo())
+		{
+			FrameInfo PrevFrameInfo;
+			const double FrameDuration = FrameIndex > 0 && LoadedSession.getFrameInfo(FrameIndex - 1, PrevFrameInfo) ? CurrentFrameInfo.time - PrevFrameInfo.time : 0.0;
+			ImGui::TextDisabled("%.3fs  Frame %d/%d (%.1f ms)  Display %.0fx%.0f  Inputs %d", CurrentFrameInfo.time, FrameIndex, LoadedSession.nFrames(),
+				FrameDuration * 1000.0, CurrentFrameInfo.displaySize.x, CurrentFrameInfo.displaySize.y, (int32)CurrentFrameInfo.inputs.size());
+		}
+		else
+		{
+			ImGui::TextDisabled("Frame %d/%d (no timing recorded)", FrameIndex, LoadedSession.nFrames());
+		}
 		ImGui::SameLine(WindowWidth - 60.f);
 		if (ImGui::Button("Quit"))
 		{
@@ -67,9 +164,40 @@ void FImGuiWS_Replay::Draw(float DeltaTime, bool& CloseReplay)
 		default: ;
 		}
 		ImGui::SameLine();
+		if (ImGui::Button(ICON_FA_BACKWARD))
+		{
+			PlayState = EPlayState::Pause;
+			SeekFrame(FrameIndex - 1);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button(ICON_FA_FORWARD))
+		{
+			PlayState = EPlayState::Pause;
+			SeekFrame(FrameIndex + 1);
+		}
+		ImGui::SameLine();
+
+		static constexpr float PlaySpeeds[] = { 0.25f, 0.5f, 1.f, 2.f, 4.f, 8.f };
+		ImGui::SetNextItemWidth(70.f);
+		if (ImGui::BeginCombo("##PlaySpeed", TCHAR_TO_UTF8(*FString::Printf(TEXT("%gx"), PlaySpeed))))
+		{
+			for (const float Speed : PlaySpeeds)
+			{
+				if (ImGui::Selectable(TCHAR_TO_UTF8(*FString::Printf(TEXT("%gx"), Speed)), Speed == PlaySpeed))
+				{
+					PlaySpeed = Speed;
+				}
+			}
+			ImGui::EndCombo();
+		}
+		ImGui::SameLine();
 
 		ImGui::SetNextItemWidth(-30.f);
-		ImGui::SliderInt("##PlayPosition", &FrameIndex, 0, LoadedSession.nFrames() - 1);
+		int32 SliderFrameIndex = FrameIndex;
+		if (ImGui::SliderInt("##PlayPosition", &SliderFrameIndex, 0, LoadedSession.nFrames() - 1))
+		{
+			SeekFrame(SliderFrameIndex);
+		}
 	}
 	ImGui::End();
 
@@ -79,6 +207,55 @@ void FImGuiWS_Replay::Draw(float DeltaTime, bool& CloseReplay)
 
 bool FImGuiWS_Replay::GetDrawData(FDrawData& DrawData)
 {
-	return LoadedSession.getFrame(FrameIndex, &DrawData.drawData, DrawData.drawLists, ImGui::GetDrawListSharedData());
+	FrameInfo Info;
+	if (LoadedSession.getFrame(FrameIndex, &DrawData.drawData, DrawData.drawLists, ImGui::GetDrawListSharedData(), &Info) == false)
+	{
+		return false;
+	}
+	UpdateTextures(Info, DrawData);
+	return true;
+}
+
+void FImGuiWS_Replay::UpdateTextures(const FrameInfo& Info, FDrawData& DrawData)
+{
+	// recordings without textures keep drawing with the live ones
+	if (Info.textures.empty())
+	{
+		return;
+	}
+
+	for (const TextureRef& Ref : Info.textures)
+	{
+		FReplayTexture& ReplayTexture = ReplayTextures.FindOrAdd(Ref.id);
+		if (ReplayTexture.Handle.IsValid() && ReplayTexture.Hash == Ref.hash)
+		{
+			continue;
+		}
+		TextureData Texture;
+		if (LoadedSession.getTexture(Ref.hash, Texture) == false)
+		{
+			continue;
+		}
+		if (ReplayTexture.Handle.IsValid() == false)
+		{
+			ReplayTexture.Handle = FImGuiTextureHandle::MakeUnique();
+		}
+		ReplayTexture.Hash = Ref.hash;
+		if (UnrealImGui::Private::UpdateTextureData_WS)
+		{
+			UnrealImGui::Private::UpdateTextureData_WS(ReplayTexture.Handle, UnrealImGui::ETextureFormat(Texture.type), Texture.width, Texture.height, (const uint8*)Texture.pixels.data());
+		}
+	}
+
+	for (int32 ListIdx = 0; ListIdx < DrawData->CmdListsCount; ++ListIdx)
+	{
+		for (ImDrawCmd& Cmd : DrawData->CmdLists[ListIdx]->CmdBuffer)
+		{
+			if (const FReplayTexture* ReplayTexture = ReplayTextures.Find((uint32)Cmd.TextureId))
+			{
+				Cmd.TextureId = (uint32)ReplayTexture->Handle;
+			}
+		}
+	}
 }
 }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "imgui-ws-record.h"
+#include "UnrealImGuiTexture.h"
 
 namespace ImGuiWS_Record
 {
@@ -10,6 +11,7 @@ class FImGuiWS_Replay
 {
 public:
 	FImGuiWS_Replay(const char* FilePath);
+	~FImGuiWS_Replay();
 
 	void Draw(float DeltaTime, bool& CloseReplay);
 
@@ -25,6 +27,15 @@ public:
 		std::vector<ImDrawList> drawLists;
 	};
 	bool GetDrawData(FDrawData& DrawData);
+
+	int32 GetFrameIndex() const { return FrameIndex; }
+	int32 GetNumFrames() const { return LoadedSession.nFrames(); }
+	double GetPlayTime() const { return PlayTime; }
+	bool IsPlaying() const { return PlayState == EPlayState::Play; }
+	const FrameInfo& GetFrameInfo() const { return CurrentFrameInfo; }
+
+	// ImGuiWS::FEvent::ReplayControl of the controlling client, like the buttons and slider of the control bar
+	void HandleControl(int32 Command, int32 Frame);
 private:
 	Session LoadedSession;
 	float WindowHeightOffset = 0.f;
@@ -36,5 +47,23 @@ private:
 	};
 	EPlayState PlayState = EPlayState::Play;
 	int32 FrameIndex = 0;
+	// replay clock in recording time, frames are shown once it passes their capture time
+	double PlayTime = 0.0;
+	float PlaySpeed = 1.f;
+	double LastFrameDuration = 0.0;
+	FrameInfo CurrentFrameInfo;
+
+	void SeekFrame(int32 Index);
+	void AdvancePlayTime(float DeltaTime);
+
+	// recorded textures are uploaded under their own handles, the replayed draw commands are remapped to them
+	// a changed texture is uploaded again under the same handle, the handles are released with the replay
+	struct FReplayTexture
+	{
+		FImGuiTextureHandle Handle;
+		uint64 Hash = 0;
+	};
+	TMap<uint32, FReplayTexture> ReplayTextures;
+	void UpdateTextures(const FrameInfo& Info, FDrawData& DrawData);
 };
 }
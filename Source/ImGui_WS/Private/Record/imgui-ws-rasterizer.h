@@ -0,0 +1,216 @@
+/*! \file imgui-ws-rasterizer.h
+ *  \brief CPU rasterizer for Dear ImGui DrawData
+ */
+
+#pragma once
+
+#include "imgui-ws-record.h"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+namespace ImGuiWS_Record {
+
+// RGBA8 pixels, row major without padding
+struct Image {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<uint8_t> pixels;
+
+    void resize(int32_t w, int32_t h, uint32_t clearColor) {
+        width = w;
+        height = h;
+        pixels.resize((size_t) w * h * 4);
+        const uint8_t rgba[4] = {
+            (uint8_t) ((clearColor >> IM_COL32_R_SHIFT) & 0xFF),
+            (uint8_t) ((clearColor >> IM_COL32_G_SHIFT) & 0xFF),
+            (uint8_t) ((clearColor >> IM_COL32_B_SHIFT) & 0xFF),
+            (uint8_t) ((clearColor >> IM_COL32_A_SHIFT) & 0xFF),
+        };
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            memcpy(pixels.data() + i, rgba, 4);
+        }
+    }
+};
+
+// texture of a draw command, nullptr draws the vertex colors only
+using TextureLookup = std::function<const TextureData * (ImTextureID)>;
+
+// renders the draw data the way the web client does: textured triangles, vertex colors,
+// clip rects and SrcAlpha/OneMinusSrcAlpha blending, textures are sampled with the nearest texel
+// the target keeps its size, draw data outside of it is clipped
+struct Rasterizer {
+    void render(const ImDrawData * drawData, const TextureLookup & lookup, Image & target) {
+        const ImVec2 origin = drawData->DisplayPos;
+        const ImVec2 scale = drawData->FramebufferScale.x > 0.0f ? drawData->FramebufferScale : ImVec2(1.0f, 1.0f);
+
+        for (int32_t iList = 0; iList < drawData->CmdListsCount; ++iList) {
+            const ImDrawList * cmdList = drawData->CmdLists[iList];
+            for (const ImDrawCmd & cmd : cmdList->CmdBuffer) {
+                if (cmd.UserCallback != nullptr || cmd.ElemCount == 0) continue;
+
+                Clip clip;
+                clip.x0 = std::max(0, (int32_t) std::floor((cmd.ClipRect.x - origin.x) * scale.x));
+                clip.y0 = std::max(0, (int32_t) std::floor((cmd.ClipRect.y - origin.y) * scale.y));
+                clip.x1 = std::min(target.width, (int32_t) std::ceil((cmd.ClipRect.z - origin.x) * scale.x));
+                clip.y1 = std::min(target.height, (int32_t) std::ceil((cmd.ClipRect.w - origin.y) * scale.y));
+                if (clip.x0 >= clip.x1 || clip.y0 >= clip.y1) continue;
+
+                const TextureData * texture = lookup ? lookup(cmd.TextureId) : nullptr;
+                for (uint32_t i = 0; i + 2 < cmd.ElemCount; i += 3) {
+                    const uint32_t idx = cmd.IdxOffset + i;
+                    if (idx + 2 >= (uint32_t) cmdList->IdxBuffer.Size) break;
+
+                    Vertex v[3];
+                    bool valid = true;
+                    for (int k = 0; k < 3; ++k) {
+                        const uint32_t vtx = cmd.VtxOffset + cmdList->IdxBuffer[idx + k];
+                        if (vtx >= (uint32_t) cmdList->VtxBuffer.Size) {
+                            valid = false;
+                            break;
+                        }
+                        const ImDrawVert & src = cmdList->VtxBuffer[vtx];
+                        v[k].x = (src.pos.x - origin.x) * scale.x;
+                        v[k].y = (src.pos.y - origin.y) * scale.y;
+                        v[k].u = src.uv.x;
+                        v[k].v = src.uv.y;
+                        v[k].r = (float) ((src.col >> IM_COL32_R_SHIFT) & 0xFF);
+                        v[k].g = (float) ((src.col >> IM_COL32_G_SHIFT) & 0xFF);
+                        v[k].b = (float) ((src.col >> IM_COL32_B_SHIFT) & 0xFF);
+                        v[k].a = (float) ((src.col >> IM_COL32_A_SHIFT) & 0xFF);
+                    }
+                    if (valid) {
+                        drawTriangle(v, clip, texture, target);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Vertex {
+        float x, y;
+        float u, v;
+        float r, g, b, a;
+    };
+
+    struct Clip {
+        int32_t x0, y0, x1, y1;
+    };
+
+    // texel as rgba 0..255, formats follow ImGuiWS::FTexture::Type
+    static void sample(const TextureData & texture, float u, float v, float * out) {
+        const int32_t x = std::min(std::max((int32_t) (u * texture.width), 0), texture.width - 1);
+        const int32_t y = std::min(std::max((int32_t) (v * texture.height), 0), texture.height - 1);
+        const size_t texel = (size_t) y * texture.width + x;
+        const uint8_t * p = (const uint8_t *) texture.pixels.data();
+        switch (texture.type) {
+            case 0: // Alpha8
+                out[0] = out[1] = out[2] = 255.0f;
+                out[3] = p[texel];
+                break;
+            case 1: // Gray8
+                out[0] = out[1] = out[2] = p[texel];
+                out[3] = 255.0f;
+                break;
+            case 2: // RGB24
+                out[0] = p[texel * 3 + 0];
+                out[1] = p[texel * 3 + 1];
+                out[2] = p[texel * 3 + 2];
+                out[3] = 255.0f;
+                break;
+            default: // RGBA32
+                out[0] = p[texel * 4 + 0];
+                out[1] = p[texel * 4 + 1];
+                out[2] = p[texel * 4 + 2];
+                out[3] = p[texel * 4 + 3];
+                break;
+        }
+    }
+
+    static bool isValid(const TextureData * texture) {
+        if (texture == nullptr || texture->width <= 0 || texture->height <= 0) return false;
+        const size_t bpp = texture->type == 2 ? 3 : texture->type == 3 ? 4 : 1;
+        return texture->pixels.size() >= (size_t) texture->width * texture->height * bpp;
+    }
+
+    // edge functions over pixel centers with the top-left rule, the shared diagonal of a quad is drawn once
+    static void drawTriangle(Vertex * v, const Clip & clip, const TextureData * texture, Image & target) {
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+        if (area == 0.0f) return;
+        if (area < 0.0f) {
+            std::swap(v[1], v[2]);
+            area = -area;
+        }
+
+        const int32_t x0 = std::max(clip.x0, (int32_t) std::floor(std::min({ v[0].x, v[1].x, v[2].x })));
+        const int32_t y0 = std::max(clip.y0, (int32_t) std::floor(std::min({ v[0].y, v[1].y, v[2].y })));
+        const int32_t x1 = std::min(clip.x1, (int32_t) std::ceil(std::max({ v[0].x, v[1].x, v[2].x })));
+        const int32_t y1 = std::min(clip.y1, (int32_t) std::ceil(std::max({ v[0].y, v[1].y, v[2].y })));
+        if (x0 >= x1 || y0 >= y1) return;
+
+        const bool textured = isValid(texture);
+        const float invArea = 1.0f / area;
+
+        struct Edge {
+            float a, b, c;
+            float bias;
+        } edges[3];
+        for (int k = 0; k < 3; ++k) {
+            const Vertex & p = v[(k + 1) % 3];
+            const Vertex & q = v[(k + 2) % 3];
+            // weight of vertex k, positive inside
+            edges[k].a = p.y - q.y;
+            edges[k].b = q.x - p.x;
+            edges[k].c = p.x * q.y - p.y * q.x;
+            const bool topLeft = (edges[k].a == 0.0f && edges[k].b < 0.0f) || edges[k].a > 0.0f;
+            edges[k].bias = topLeft ? 0.0f : -1e-6f;
+        }
+
+        uint8_t * pixels = target.pixels.data();
+        float texel[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+        for (int32_t y = y0; y < y1; ++y) {
+            const float py = y + 0.5f;
+            for (int32_t x = x0; x < x1; ++x) {
+                const float px = x + 0.5f;
+                float w[3];
+                bool inside = true;
+                for (int k = 0; k < 3; ++k) {
+                    w[k] = edges[k].a * px + edges[k].b * py + edges[k].c;
+                    if (w[k] < 0.0f || (w[k] == 0.0f && edges[k].bias < 0.0f)) {
+                        inside = false;
+                        break;
+                    }
+                }
+                if (!inside) continue;
+
+                w[0] *= invArea;
+                w[1] *= invArea;
+                w[2] *= invArea;
+
+                if (textured) {
+                    const float u = w[0] * v[0].u + w[1] * v[1].u + w[2] * v[2].u;
+                    const float t = w[0] * v[0].v + w[1] * v[1].v + w[2] * v[2].v;
+                    sample(*texture, u, t, texel);
+                }
+                const float srcA = (w[0] * v[0].a + w[1] * v[1].a + w[2] * v[2].a) * texel[3] * (1.0f / (255.0f * 255.0f));
+                if (srcA <= 0.0f) continue;
+
+                const float src[3] = {
+                    (w[0] * v[0].r + w[1] * v[1].r + w[2] * v[2].r) * texel[0] * (1.0f / 255.0f),
+                    (w[0] * v[0].g + w[1] * v[1].g + w[2] * v[2].g) * texel[1] * (1.0f / 255.0f),
+                    (w[0] * v[0].b + w[1] * v[1].b + w[2] * v[2].b) * texel[2] * (1.0f / 255.0f),
+                };
+                uint8_t * dst = pixels + ((size_t) y * target.width + x) * 4;
+                for (int c = 0; c < 3; ++c) {
+                    dst[c] = (uint8_t) std::min(255.0f, src[c] * srcA + dst[c] * (1.0f - srcA) + 0.5f);
+                }
+                dst[3] = (uint8_t) std::min(255.0f, srcA * 255.0f + dst[3] * (1.0f - srcA) + 0.5f);
+            }
+        }
+    }
+};
+
+}
@@ -5,10 +5,25 @@
 #pragma once
 
 #include "imgui.h"
+#include "Misc/Compression.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
 
 #include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 #include <fstream>
 #include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <string>
 
 namespace ImGuiWS_Record{
 
@@ -68,7 +83,7 @@ template<>
     }
 
 template<typename T>
-    inline void unserialize(ImVector<T> & t, std::vector<char> & buf, size_t & offset) {
+    inline void unserialize(ImVector<T> & t, const std::vector<char> & buf, size_t & offset) {
         uint32_t n = 0;
         unserialize(n, buf, offset);
         t.resize(n);
@@ -77,7 +92,7 @@ template<typename T>
     }
 
 template<>
-    inline void unserialize<ImDrawCmd>(ImVector<ImDrawCmd> & t, std::vector<char> & buf, size_t & offset) {
+    inline void unserialize<ImDrawCmd>(ImVector<ImDrawCmd> & t, const std::vector<char> & buf, size_t & offset) {
         uint32_t n = 0;
         unserialize(n, buf, offset);
         t.resize(n);
@@ -86,85 +101,909 @@ template<>
         }
     }
 
-struct Session {
-    constexpr static auto kHeader = "Dear ImGui DrawData v1.0";
+using FrameData = std::vector<char>;
 
-    using FrameData = std::vector<char>;
+// input of the controlling client applied before the frame was drawn
+struct InputEvent {
+    int32_t type = 0;               // ImGuiWS::FEvent::EType
+    float x = 0.0f;                 // mouse position, wheel delta or window size
+    float y = 0.0f;
+    int32_t key = 0;                // key code or mouse button
+    std::string text;               // pasted or inputted text
+};
 
-    bool save(const char * fname) const {
-        std::ofstream fs(fname, std::ios::binary);
+// texture bound to an id at the time of a frame, the content is stored once per hash
+struct TextureRef {
+    uint32_t id = 0;
+    uint64_t hash = 0;
+};
+
+// capture state of a frame, appended to the draw data of v2.1 frames:
+//   [double time][float mouse x, y][float display w, h][uint32 inputs][input...][uint32 textures][texture...][uint32 info size]
+//   input: [int32 type][float x][float y][int32 key][uint32 text size][text]
+//   texture: [uint32 id][uint64 hash]
+// every frame lists all its textures, the repeated table costs next to nothing after the xor delta
+struct FrameInfo {
+    double time = 0.0;              // seconds since the first recorded frame
+    ImVec2 mousePos;
+    ImVec2 displaySize;
+    std::vector<InputEvent> inputs;
+    std::vector<TextureRef> textures;
+};
+
+// texture content: [int32 type][int32 width][int32 height][pixels], type is ImGuiWS::FTexture::Type
+struct TextureData {
+    int32_t type = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<char> pixels;
+};
+
+inline void serialize(const FrameInfo & info, std::vector<char> & buf) {
+    const size_t start = buf.size();
+    serialize(info.time, buf);
+    serialize(info.mousePos.x, buf);
+    serialize(info.mousePos.y, buf);
+    serialize(info.displaySize.x, buf);
+    serialize(info.displaySize.y, buf);
+    serialize((uint32_t) info.inputs.size(), buf);
+    for (const auto & input : info.inputs) {
+        serialize(input.type, buf);
+        serialize(input.x, buf);
+        serialize(input.y, buf);
+        serialize(input.key, buf);
+        serialize((uint32_t) input.text.size(), buf);
+        buf.insert(buf.end(), input.text.begin(), input.text.end());
+    }
+    serialize((uint32_t) info.textures.size(), buf);
+    for (const auto & texture : info.textures) {
+        serialize(texture.id, buf);
+        serialize(texture.hash, buf);
+    }
+    serialize((uint32_t) (buf.size() - start), buf);
+}
+
+// the info size trailer makes it readable without walking the draw lists
+inline bool unserialize(FrameInfo & info, const std::vector<char> & buf) {
+    uint32_t infoSize = 0;
+    if (buf.size() < sizeof(infoSize)) return false;
+    size_t offset = buf.size() - sizeof(infoSize);
+    unserialize(infoSize, buf, offset);
+    if (infoSize > buf.size() - sizeof(infoSize)) return false;
+
+    const size_t end = buf.size() - sizeof(infoSize);
+    offset = end - infoSize;
+    unserialize(info.time, buf, offset);
+    unserialize(info.mousePos.x, buf, offset);
+    unserialize(info.mousePos.y, buf, offset);
+    unserialize(info.displaySize.x, buf, offset);
+    unserialize(info.displaySize.y, buf, offset);
+    uint32_t nInputs = 0;
+    unserialize(nInputs, buf, offset);
+    info.inputs.clear();
+    for (uint32_t i = 0; i < nInputs; ++i) {
+        InputEvent input;
+        uint32_t textSize = 0;
+        if (offset + sizeof(int32_t) * 2 + sizeof(float) * 2 + sizeof(textSize) > end) return false;
+        unserialize(input.type, buf, offset);
+        unserialize(input.x, buf, offset);
+        unserialize(input.y, buf, offset);
+        unserialize(input.key, buf, offset);
+        unserialize(textSize, buf, offset);
+        if (offset + textSize > end) return false;
+        input.text.assign(buf.data() + offset, textSize);
+        offset += textSize;
+        info.inputs.emplace_back(std::move(input));
+    }
+    // early v2.1 recordings end here
+    uint32_t nTextures = 0;
+    info.textures.clear();
+    if (offset + sizeof(nTextures) <= end) {
+        unserialize(nTextures, buf, offset);
+        if (offset + nTextures * (sizeof(uint32_t) + sizeof(uint64_t)) > end) return false;
+        info.textures.resize(nTextures);
+        for (auto & texture : info.textures) {
+            unserialize(texture.id, buf, offset);
+            unserialize(texture.hash, buf, offset);
+        }
+    }
+    return offset == end;
+}
+
+inline void serialize(const ImDrawData * drawData, FrameData & frame) {
+    serialize(drawData->Valid, frame);
+    serialize(drawData->CmdListsCount, frame);
+    serialize(drawData->TotalIdxCount, frame);
+    serialize(drawData->TotalVtxCount, frame);
+    serialize(drawData->DisplayPos.x, frame);
+    serialize(drawData->DisplayPos.y, frame);
+    serialize(drawData->DisplaySize.x, frame);
+    serialize(drawData->DisplaySize.y, frame);
+    serialize(drawData->FramebufferScale.x, frame);
+    serialize(drawData->FramebufferScale.y, frame);
+
+    for (int32_t iList = 0; iList < drawData->CmdListsCount; ++iList) {
+        auto & cmdList = drawData->CmdLists[iList];
+
+        serialize(cmdList->CmdBuffer, frame);
+        serialize(cmdList->VtxBuffer, frame);
+        serialize(cmdList->IdxBuffer, frame);
+        serialize(cmdList->Flags, frame);
+    }
+}
+
+inline uint64_t textureHash(int32_t type, int32_t width, int32_t height, const void * pixels, size_t size) {
+    return CityHash64WithSeed((const char *) pixels, (uint32) size, ((uint64_t) type << 56) ^ ((uint64_t) width << 28) ^ (uint64_t) height);
+}
+
+inline void serializeTexture(int32_t type, int32_t width, int32_t height, const void * pixels, size_t size, std::vector<char> & texture) {
+    texture.reserve(texture.size() + sizeof(int32_t) * 3 + size);
+    serialize(type, texture);
+    serialize(width, texture);
+    serialize(height, texture);
+    texture.insert(texture.end(), (const char *) pixels, (const char *) pixels + size);
+}
+
+// v2 container:
+//   [kHeader][chunk...][index][uint64 index offset][kIndexMagic]
+//   chunk: [uint32 first frame][uint32 frames][uint32 raw size][uint32 stored size][data]
+//          data is lz4 compressed when stored size < raw size
+//   chunk raw data, per frame: [uint32 size][bytes]
+//          the first frame of a chunk is a keyframe, the others are xor'ed with the previous frame
+//   texture: a chunk with 0 frames and [uint64 hash] between header and data, raw data is a TextureData
+//   index: [uint32 chunks] per chunk [uint64 offset][uint32 first frame][uint32 frames]
+//          [uint32 textures] per texture [uint64 hash][uint64 offset], missing in files without textures
+// every chunk decodes on its own, seeking is a binary search in the index plus one chunk decode
+// v2.1 frames end with a FrameInfo, v2.0 frames are draw data only
+namespace V2 {
+    constexpr static auto kHeader = "Dear ImGui DrawData v2.1";
+    constexpr static auto kHeaderNoFrameInfo = "Dear ImGui DrawData v2.0";
+    constexpr static char kIndexMagic[8] = { 'I', 'M', 'R', 'C', 'I', 'D', 'X', '2' };
+    constexpr static uint32_t kKeyframeInterval = 120;
+    constexpr static size_t kChunkSize = 4*1024*1024;
+
+    struct ChunkInfo {
+        uint64_t offset = 0;
+        uint32_t firstFrame = 0;
+        uint32_t nFrames = 0;
+    };
+
+    struct ChunkHeader {
+        uint32_t firstFrame = 0;
+        uint32_t nFrames = 0;
+        uint32_t rawSize = 0;
+        uint32_t storedSize = 0;
+    };
+
+    struct TextureInfo {
+        uint64_t hash = 0;
+        uint64_t offset = 0;
+    };
+
+    inline uint64_t recordSize(const ChunkHeader & header) {
+        return sizeof(header) + (header.nFrames == 0 ? sizeof(uint64_t) : 0) + header.storedSize;
+    }
+
+    // raw data of one chunk, the first frame is a keyframe and the others are xor'ed with the previous frame
+    struct ChunkEncoder {
+        void addFrame(const FrameData & frame) {
+            const bool keyframe = nFrames == 0;
+            const uint32_t frameSize = frame.size();
+            std::copy((char *)(&frameSize), (char *)(&frameSize) + sizeof(frameSize), std::back_inserter(raw));
+            const size_t offset = raw.size();
+            raw.insert(raw.end(), frame.begin(), frame.end());
+            if (!keyframe) {
+                const size_t n = std::min(prevFrame.size(), frame.size());
+                for (size_t i = 0; i < n; ++i) {
+                    raw[offset + i] ^= prevFrame[i];
+                }
+            }
+            prevFrame = frame;
+            nFrames += 1;
+        }
+
+        bool isFull(uint32_t maxFrames = kKeyframeInterval, size_t maxSize = kChunkSize) const {
+            return nFrames >= maxFrames || raw.size() >= maxSize;
+        }
+
+        void reset() {
+            raw.clear();
+            nFrames = 0;
+        }
+
+        std::vector<char> raw;
+        uint32_t nFrames = 0;
+
+    private:
+        FrameData prevFrame;
+    };
+
+    // stored form of a record, lz4 compressed unless that is not smaller
+    inline void encodeRecord(const std::vector<char> & raw, std::vector<char> & stored) {
+        int32 compressedSize = FCompression::CompressMemoryBound(NAME_LZ4, (int32) raw.size());
+        stored.resize(compressedSize);
+        if (FCompression::CompressMemory(NAME_LZ4, stored.data(), compressedSize, raw.data(), (int32) raw.size()) && compressedSize < (int32) raw.size()) {
+            stored.resize(compressedSize);
+        } else {
+            stored = raw;
+        }
+    }
+
+    struct Writer {
+        explicit Writer(std::ostream & fs, bool frameInfo = true) : fs(fs) {
+            const char * header = frameInfo ? kHeader : kHeaderNoFrameInfo;
+            fs.write(header, strlen(header));
+        }
+
+        void addFrame(const FrameData & frame) {
+            encoder.addFrame(frame);
+            if (encoder.isFull()) {
+                flushChunk();
+            }
+        }
+
+        void flushChunk() {
+            if (encoder.nFrames == 0) return;
+
+            encodeRecord(encoder.raw, stored);
+            addEncodedChunk(encoder.nFrames, encoder.raw.size(), stored);
+            encoder.reset();
+        }
+
+        // chunk encoded elsewhere with ChunkEncoder and encodeRecord, the pending frames must have been flushed
+        void addEncodedChunk(uint32_t frames, uint32_t rawSize, const std::vector<char> & chunk) {
+            chunks.push_back({ (uint64_t) fs.tellp(), nFrames, frames });
+            writeRecord(frames, rawSize, chunk, nullptr);
+            nFrames += frames;
+        }
+
+        // texture is a serialized TextureData, written right away in between the frame chunks
+        void addTexture(uint64_t hash, const std::vector<char> & texture) {
+            encodeRecord(texture, stored);
+            addEncodedTexture(hash, texture.size(), stored);
+        }
+
+        void addEncodedTexture(uint64_t hash, uint32_t rawSize, const std::vector<char> & texture) {
+            textures.push_back({ hash, (uint64_t) fs.tellp() });
+            writeRecord(0, rawSize, texture, &hash);
+        }
+
+        bool finish() {
+            flushChunk();
+
+            const uint64_t indexOffset = fs.tellp();
+            const uint32_t nChunks = chunks.size();
+            fs.write((char *)(&nChunks), sizeof(nChunks));
+            for (const auto & chunk : chunks) {
+                fs.write((char *)(&chunk.offset), sizeof(chunk.offset));
+                fs.write((char *)(&chunk.firstFrame), sizeof(chunk.firstFrame));
+                fs.write((char *)(&chunk.nFrames), sizeof(chunk.nFrames));
+            }
+            const uint32_t nTextures = textures.size();
+            fs.write((char *)(&nTextures), sizeof(nTextures));
+            for (const auto & texture : textures) {
+                fs.write((char *)(&texture.hash), sizeof(texture.hash));
+                fs.write((char *)(&texture.offset), sizeof(texture.offset));
+            }
+            fs.write((char *)(&indexOffset), sizeof(indexOffset));
+            fs.write(kIndexMagic, sizeof(kIndexMagic));
+            fs.flush();
+
+            return (bool) fs;
+        }
+
+    private:
+        void writeRecord(uint32_t frames, uint32_t rawSize, const std::vector<char> & data, const uint64_t * hash) {
+            ChunkHeader header;
+            header.firstFrame = nFrames;
+            header.nFrames = frames;
+            header.rawSize = rawSize;
+            header.storedSize = data.size();
+            fs.write((char *)(&header), sizeof(header));
+            if (hash) {
+                fs.write((char *)(hash), sizeof(*hash));
+            }
+            fs.write(data.data(), data.size());
+        }
+
+        std::ostream & fs;
+        std::vector<ChunkInfo> chunks;
+        std::vector<TextureInfo> textures;
+        uint32_t nFrames = 0;
+        ChunkEncoder encoder;
+        std::vector<char> stored;
+    };
+
+    // reads the trailing index, a file without it (interrupted capture) is indexed by walking the chunk headers
+    inline bool readIndex(const char * data, uint64_t fileSize, std::vector<ChunkInfo> & chunks, std::vector<TextureInfo> & textures, uint32_t & nFrames) {
+        chunks.clear();
+        textures.clear();
+        nFrames = 0;
+
+        const uint64_t headerSize = strlen(kHeader);
 
-        fs.write(kHeader, strlen(kHeader));
+        char magic[sizeof(kIndexMagic)] = {};
+        uint64_t indexOffset = 0;
+        if (fileSize >= headerSize + sizeof(indexOffset) + sizeof(magic)) {
+            memcpy(&indexOffset, data + fileSize - sizeof(magic) - sizeof(indexOffset), sizeof(indexOffset));
+            memcpy(magic, data + fileSize - sizeof(magic), sizeof(magic));
+        }
+
+        constexpr uint64_t kEntrySize = sizeof(uint64_t) + sizeof(uint32_t) * 2;
+        uint32_t nChunks = 0;
+        const uint64_t indexEnd = fileSize - sizeof(magic) - sizeof(indexOffset);
+        if (memcmp(magic, kIndexMagic, sizeof(magic)) == 0 && indexOffset + sizeof(nChunks) <= indexEnd) {
+            memcpy(&nChunks, data + indexOffset, sizeof(nChunks));
+        }
 
-        uint32_t nFrames = frames.size();
-        fs.write((char *)(&nFrames), sizeof(nFrames));
+        if (nChunks > 0 && indexOffset + sizeof(nChunks) + nChunks * kEntrySize <= indexEnd) {
+            const char * entry = data + indexOffset + sizeof(nChunks);
+            chunks.resize(nChunks);
+            for (auto & chunk : chunks) {
+                memcpy(&chunk.offset, entry, sizeof(chunk.offset));
+                memcpy(&chunk.firstFrame, entry + sizeof(chunk.offset), sizeof(chunk.firstFrame));
+                memcpy(&chunk.nFrames, entry + sizeof(chunk.offset) + sizeof(chunk.firstFrame), sizeof(chunk.nFrames));
+                entry += kEntrySize;
+            }
 
-        for (uint32_t i = 0; i < nFrames; ++i) {
-            uint32_t frameSize = frames[i].size();
-            fs.write((char *)(&frameSize), sizeof(frameSize));
-            fs.write((char *)(frames[i].data()), frames[i].size());
+            constexpr uint64_t kTextureEntrySize = sizeof(uint64_t) * 2;
+            uint32_t nTextures = 0;
+            if (entry + sizeof(nTextures) <= data + indexEnd) {
+                memcpy(&nTextures, entry, sizeof(nTextures));
+                entry += sizeof(nTextures);
+            }
+            if (entry + nTextures * kTextureEntrySize <= data + indexEnd) {
+                textures.resize(nTextures);
+                for (auto & texture : textures) {
+                    memcpy(&texture.hash, entry, sizeof(texture.hash));
+                    memcpy(&texture.offset, entry + sizeof(texture.hash), sizeof(texture.offset));
+                    entry += kTextureEntrySize;
+                }
+            }
+        } else {
+            // no trailer, the recording was cut short: walk the chunk headers up to the first incomplete one
+            uint64_t offset = headerSize;
+            uint32_t nextFrame = 0;
+            while (offset + sizeof(ChunkHeader) <= fileSize) {
+                ChunkHeader header;
+                memcpy(&header, data + offset, sizeof(header));
+                if (header.firstFrame != nextFrame || header.storedSize > header.rawSize ||
+                    offset + recordSize(header) > fileSize) break;
+                if (header.nFrames == 0) {
+                    TextureInfo texture;
+                    memcpy(&texture.hash, data + offset + sizeof(header), sizeof(texture.hash));
+                    texture.offset = offset;
+                    textures.push_back(texture);
+                } else {
+                    nextFrame += header.nFrames;
+                    chunks.push_back({ offset, header.firstFrame, header.nFrames });
+                }
+                offset += recordSize(header);
+            }
         }
 
+        for (const auto & chunk : chunks) {
+            if (chunk.offset + sizeof(ChunkHeader) > fileSize) return false;
+        }
+        if (!chunks.empty()) {
+            nFrames = chunks.back().firstFrame + chunks.back().nFrames;
+        }
         return true;
     }
 
-    bool load(const char * fname) {
-        std::ifstream fs(fname, std::ios::binary);
-        char header[64];
-        std::fill(header, header + 64, 0);
-        fs.read(header, strlen(kHeader));
-        if (strcmp(header, kHeader)) {
+    // stored records are used straight from the mapping, only compressed ones are uncompressed into buffer
+    inline const char * readRecord(const char * data, uint64_t fileSize, uint64_t offset, ChunkHeader & header, std::vector<char> & buffer) {
+        if (offset + sizeof(header) > fileSize) return nullptr;
+        memcpy(&header, data + offset, sizeof(header));
+        if (offset + recordSize(header) > fileSize) return nullptr;
+
+        const char * stored = data + offset + recordSize(header) - header.storedSize;
+        if (header.storedSize < header.rawSize) {
+            buffer.resize(header.rawSize);
+            if (!FCompression::UncompressMemory(NAME_LZ4, buffer.data(), buffer.size(), stored, header.storedSize)) {
+                return nullptr;
+            }
+            return buffer.data();
+        }
+        return stored;
+    }
+
+    inline bool readTexture(const char * data, uint64_t fileSize, const TextureInfo & info, TextureData & texture) {
+        ChunkHeader header;
+        std::vector<char> buffer;
+        const char * raw = readRecord(data, fileSize, info.offset, header, buffer);
+        if (raw == nullptr || header.nFrames != 0) return false;
+
+        constexpr size_t kTextureHeaderSize = sizeof(int32_t) * 3;
+        if (header.rawSize < kTextureHeaderSize) return false;
+        memcpy(&texture.type, raw, sizeof(texture.type));
+        memcpy(&texture.width, raw + sizeof(int32_t), sizeof(texture.width));
+        memcpy(&texture.height, raw + sizeof(int32_t) * 2, sizeof(texture.height));
+        texture.pixels.assign(raw + kTextureHeaderSize, raw + header.rawSize);
+        return true;
+    }
+
+    inline bool readChunk(const char * data, uint64_t fileSize, const ChunkInfo & info, std::vector<FrameData> & frames) {
+        ChunkHeader header;
+        std::vector<char> buffer;
+        const char * raw = readRecord(data, fileSize, info.offset, header, buffer);
+        if (raw == nullptr || header.nFrames == 0) return false;
+
+        frames.resize(header.nFrames);
+        size_t offset = 0;
+        for (uint32_t i = 0; i < header.nFrames; ++i) {
+            uint32_t frameSize = 0;
+            if (offset + sizeof(frameSize) > header.rawSize) return false;
+            memcpy(&frameSize, raw + offset, sizeof(frameSize));
+            offset += sizeof(frameSize);
+            if (offset + frameSize > header.rawSize) return false;
+
+            auto & frame = frames[i];
+            frame.assign(raw + offset, raw + offset + frameSize);
+            offset += frameSize;
+            if (i > 0) {
+                const auto & prevFrame = frames[i - 1];
+                const size_t n = std::min(prevFrame.size(), frame.size());
+                for (size_t k = 0; k < n; ++k) {
+                    frame[k] ^= prevFrame[k];
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+// read-only view of a recording, memory mapped where the platform supports it
+struct MappedFile {
+    bool open(const char * fname) {
+        close();
+
+        IPlatformFile & platformFile = FPlatformFileManager::Get().GetPlatformFile();
+        handle.Reset(platformFile.OpenMapped(UTF8_TO_TCHAR(fname)));
+        if (handle.IsValid()) {
+            region.Reset(handle->MapRegion());
+            if (region.IsValid()) {
+                mappedData = (const char *) region->GetMappedPtr();
+                mappedSize = region->GetMappedSize();
+                return true;
+            }
+            handle.Reset();
+        }
+
+        // no mapping support, read the whole file instead
+        std::ifstream fs(fname, std::ios::binary | std::ios::ate);
+        if (!fs) return false;
+        buffer.resize((size_t) fs.tellg());
+        fs.seekg(0);
+        fs.read(buffer.data(), buffer.size());
+        mappedData = buffer.data();
+        mappedSize = buffer.size();
+        return (bool) fs;
+    }
+
+    void close() {
+        region.Reset();
+        handle.Reset();
+        buffer.clear();
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+
+    const char * data() const { return mappedData; }
+    uint64_t size() const { return mappedSize; }
+
+private:
+    TUniquePtr<IMappedFileHandle> handle;
+    TUniquePtr<IMappedFileRegion> region;
+    std::vector<char> buffer;
+    const char * mappedData = nullptr;
+    uint64_t mappedSize = 0;
+};
+
+// appends frames to a v2 file on a background thread, the compression runs there as well
+// every chunk is flushed when written so a capture interrupted by a crash still loads up to the last chunk
+struct StreamWriter {
+    ~StreamWriter() {
+        close();
+    }
+
+    bool open(const char * fname, size_t maxInFlight_bytes) {
+        fs.open(fname, std::ios::binary);
+        if (!fs) {
             return false;
         }
 
+        writer = std::make_unique<V2::Writer>(fs);
+        maxInFlight = maxInFlight_bytes;
+        running = true;
+        worker = std::thread([this]() { run(); });
+        return true;
+    }
+
+    // blocks while the in-flight queue is full, the disk must keep up with the recording
+    void push(FrameData && frame) {
+        push(Item{ false, 0, std::move(frame) });
+    }
+
+    void pushTexture(uint64_t hash, std::vector<char> && texture) {
+        push(Item{ true, hash, std::move(texture) });
+    }
+
+    bool close() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+            }
+            cvWork.notify_one();
+            worker.join();
+        }
+        if (fs.is_open()) {
+            failed |= !writer->finish();
+            writer.reset();
+            fs.close();
+            return !failed;
+        }
+        return false;
+    }
+
+private:
+    struct Item {
+        bool texture = false;
+        uint64_t hash = 0;
+        std::vector<char> data;
+    };
+
+    void push(Item && item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cvSpace.wait(lock, [&]() { return inFlight_bytes < maxInFlight || !running; });
+        inFlight_bytes += item.data.size();
+        queue.emplace_back(std::move(item));
+        cvWork.notify_one();
+    }
+
+    void run() {
+        while (true) {
+            Item item;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cvWork.wait(lock, [&]() { return !queue.empty() || !running; });
+                if (queue.empty()) break;
+                item = std::move(queue.front());
+                queue.pop_front();
+                inFlight_bytes -= item.data.size();
+            }
+            cvSpace.notify_one();
+
+            if (item.texture) {
+                writer->addTexture(item.hash, item.data);
+            } else {
+                writer->addFrame(item.data);
+            }
+            fs.flush();
+            failed |= !fs;
+        }
+    }
+
+    std::ofstream fs;
+    std::unique_ptr<V2::Writer> writer;
+    bool failed = false;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cvWork;
+    std::condition_variable cvSpace;
+    std::deque<Item> queue;
+    size_t inFlight_bytes = 0;
+    size_t maxInFlight = 0;
+    bool running = false;
+};
+
+// random access to the frames of a mapped recording, frames are decoded per chunk (v1: per frame)
+// a worker decodes the chunk after the last requested one ahead of time, at most kCachedChunks stay decoded
+struct ChunkReader {
+    constexpr static auto kHeaderV1 = "Dear ImGui DrawData v1.0";
+    constexpr static size_t kCachedChunks = 4;
+
+    using Chunk = std::shared_ptr<const std::vector<FrameData>>;
+
+    ~ChunkReader() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+            }
+            cvWork.notify_one();
+            worker.join();
+        }
+    }
+
+    // only the header and the index are read, v1 files have no index and get one by walking the frame sizes
+    bool open(const char * fname) {
+        if (!file.open(fname)) return false;
+
+        const uint64_t headerSize = strlen(V2::kHeader);
+        if (file.size() < headerSize) return false;
+        const std::string header(file.data(), headerSize);
+
         uint32_t nFrames = 0;
-        fs.read((char *)(&nFrames), sizeof(nFrames));
+        if (header == V2::kHeader || header == V2::kHeaderNoFrameInfo) {
+            v2 = true;
+            frameInfo = header == V2::kHeader;
+            std::vector<V2::TextureInfo> textureList;
+            if (!V2::readIndex(file.data(), file.size(), chunks, textureList, nFrames)) return false;
+            for (const auto & texture : textureList) {
+                textures.emplace(texture.hash, texture);
+            }
+        } else if (header == kHeaderV1) {
+            uint64_t offset = headerSize;
+            if (offset + sizeof(nFrames) > file.size()) return false;
+            memcpy(&nFrames, file.data() + offset, sizeof(nFrames));
+            offset += sizeof(nFrames);
+
+            chunks.resize(nFrames);
+            for (uint32_t i = 0; i < nFrames; ++i) {
+                uint32_t frameSize = 0;
+                if (offset + sizeof(frameSize) > file.size()) return false;
+                memcpy(&frameSize, file.data() + offset, sizeof(frameSize));
+                chunks[i] = { offset, i, 1 };
+                offset += sizeof(frameSize) + frameSize;
+            }
+            if (offset > file.size()) return false;
+        } else {
+            return false;
+        }
+
+        running = true;
+        worker = std::thread([this]() { run(); });
+        return true;
+    }
+
+    int32_t findChunk(int32_t fid) const {
+        // last chunk whose first frame is <= fid
+        const auto it = std::upper_bound(chunks.begin(), chunks.end(), (uint32_t) fid, [](uint32_t frame, const V2::ChunkInfo & chunk) {
+            return frame < chunk.firstFrame;
+        });
+        return (int32_t) (it - chunks.begin()) - 1;
+    }
+
+    Chunk getChunk(int32_t chunkIdx) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cvDone.wait(lock, [&]() { return decoding != chunkIdx; });
+        Chunk chunk = findCached(chunkIdx);
+        if (!chunk) {
+            lock.unlock();
+            chunk = decode(chunkIdx);
+            lock.lock();
+            if (chunk) {
+                addCached(chunkIdx, chunk);
+            }
+        }
+
+        if (chunkIdx + 1 < (int32_t) chunks.size() && !findCached(chunkIdx + 1)) {
+            prefetch = chunkIdx + 1;
+            cvWork.notify_one();
+        }
+        return chunk;
+    }
+
+    const V2::ChunkInfo & chunkInfo(int32_t chunkIdx) const {
+        return chunks[chunkIdx];
+    }
+
+    uint32_t nFrames() const {
+        return chunks.empty() ? 0 : chunks.back().firstFrame + chunks.back().nFrames;
+    }
+
+    uint64_t fileSize() const {
+        return file.size();
+    }
+
+    bool readTexture(uint64_t hash, TextureData & texture) const {
+        const auto it = textures.find(hash);
+        return it != textures.end() && V2::readTexture(file.data(), file.size(), it->second, texture);
+    }
 
-        frames.resize(nFrames);
-        for (uint32_t i = 0; i < nFrames; ++i) {
+    bool hasFrameInfo() const {
+        return frameInfo;
+    }
+
+private:
+    Chunk decode(int32_t chunkIdx) const {
+        auto frames = std::make_shared<std::vector<FrameData>>();
+        if (v2) {
+            if (!V2::readChunk(file.data(), file.size(), chunks[chunkIdx], *frames)) return nullptr;
+        } else {
+            const uint64_t offset = chunks[chunkIdx].offset;
             uint32_t frameSize = 0;
-            fs.read((char *)(&frameSize), sizeof(frameSize));
+            memcpy(&frameSize, file.data() + offset, sizeof(frameSize));
+            const char * frame = file.data() + offset + sizeof(frameSize);
+            frames->emplace_back(frame, frame + frameSize);
+        }
+        return frames;
+    }
 
-            frames[i].resize(frameSize);
-            fs.read((char *)(frames[i].data()), frames[i].size());
+    Chunk findCached(int32_t chunkIdx) {
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (it->first == chunkIdx) {
+                std::rotate(cache.begin(), it, it + 1);
+                return cache.front().second;
+            }
         }
+        return nullptr;
+    }
+
+    void addCached(int32_t chunkIdx, const Chunk & chunk) {
+        cache.emplace_front(chunkIdx, chunk);
+        if (cache.size() > kCachedChunks) {
+            cache.pop_back();
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cvWork.wait(lock, [&]() { return prefetch >= 0 || !running; });
+            if (!running) break;
+
+            const int32_t chunkIdx = prefetch;
+            prefetch = -1;
+            if (findCached(chunkIdx)) continue;
+
+            decoding = chunkIdx;
+            lock.unlock();
+            Chunk chunk = decode(chunkIdx);
+            lock.lock();
+            if (chunk) {
+                addCached(chunkIdx, chunk);
+            }
+            decoding = -1;
+            cvDone.notify_all();
+        }
+    }
 
+    MappedFile file;
+    bool v2 = false;
+    bool frameInfo = false;
+    std::vector<V2::ChunkInfo> chunks;
+    std::unordered_map<uint64_t, V2::TextureInfo> textures;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cvWork;
+    std::condition_variable cvDone;
+    std::deque<std::pair<int32_t, Chunk>> cache;
+    int32_t prefetch = -1;
+    int32_t decoding = -1;
+    bool running = false;
+};
+
+struct Session {
+    using FrameData = ImGuiWS_Record::FrameData;
+
+    // stream the frames to fname while recording instead of keeping them in memory
+    bool beginStream(const char * fname, size_t maxInFlight_bytes = 64*1024*1024) {
+        writer = std::make_unique<StreamWriter>();
+        if (!writer->open(fname, maxInFlight_bytes)) {
+            writer.reset();
+            return false;
+        }
         return true;
     }
 
-    bool addFrame(const ImDrawData * drawData) {
-        FrameData frame;
+    bool endStream() {
+        if (!writer) return false;
+        const bool result = writer->close();
+        writer.reset();
+        return result;
+    }
 
-        serialize(drawData->Valid, frame);
-        serialize(drawData->CmdListsCount, frame);
-        serialize(drawData->TotalIdxCount, frame);
-        serialize(drawData->TotalVtxCount, frame);
-        serialize(drawData->DisplayPos.x, frame);
-        serialize(drawData->DisplayPos.y, frame);
-        serialize(drawData->DisplaySize.x, frame);
-        serialize(drawData->DisplaySize.y, frame);
-        serialize(drawData->FramebufferScale.x, frame);
-        serialize(drawData->FramebufferScale.y, frame);
+    bool isStreaming() const {
+        return writer != nullptr;
+    }
 
-        for (int32_t iList = 0; iList < drawData->CmdListsCount; ++iList) {
-            auto & cmdList = drawData->CmdLists[iList];
+    // writes the in-memory frames as v2
+    bool save(const char * fname) const {
+        std::ofstream fs(fname, std::ios::binary);
 
-            serialize(cmdList->CmdBuffer, frame);
-            serialize(cmdList->VtxBuffer, frame);
-            serialize(cmdList->IdxBuffer, frame);
-            serialize(cmdList->Flags, frame);
+        V2::Writer v2(fs, frameInfo);
+        for (const auto & [hash, texture] : textureBlobs) {
+            v2.addTexture(hash, texture);
         }
+        for (const auto & frame : frames) {
+            v2.addFrame(frame);
+        }
+
+        return v2.finish();
+    }
 
-        frames.emplace_back(std::move(frame));
+    // maps the file and reads its index, frames are decoded on demand
+    bool load(const char * fname) {
+        auto newReader = std::make_unique<ChunkReader>();
+        if (!newReader->open(fname)) {
+            return false;
+        }
 
+        reader = std::move(newReader);
+        frames.clear();
+        textureBlobs.clear();
+        currentChunk.reset();
+        currentChunkIdx = -1;
+        frameInfo = reader->hasFrameInfo();
+        frameCount = reader->nFrames();
+        totalSize = reader->fileSize();
         return true;
     }
 
-    bool getFrame(int32_t fid, ImDrawData* drawData, std::vector<ImDrawList>& drawLists, ImDrawListSharedData* drawListSharedData) {
-        if (fid >= (int32_t) frames.size()) return false;
+    // records a texture revision, the frames added afterwards reference it until the id gets a new one
+    // identical content is stored once
+    void addTexture(uint32_t id, int32_t type, int32_t width, int32_t height, const void * pixels, size_t size) {
+        const uint64_t hash = textureHash(type, width, height, pixels, size);
+        liveTextures[id] = hash;
+        if (!storedTextures.emplace(hash).second) {
+            return;
+        }
 
+        std::vector<char> texture;
+        serializeTexture(type, width, height, pixels, size, texture);
+        totalSize += texture.size();
+        if (writer) {
+            writer->pushTexture(hash, std::move(texture));
+        } else {
+            textureBlobs.emplace(hash, std::move(texture));
+        }
+    }
+
+    bool getTexture(uint64_t hash, TextureData & texture) const {
+        if (reader) {
+            return reader->readTexture(hash, texture);
+        }
+        const auto it = textureBlobs.find(hash);
+        if (it == textureBlobs.end() || it->second.size() < sizeof(int32_t) * 3) return false;
         size_t offset = 0;
-        auto & buf = frames[fid];
+        unserialize(texture.type, it->second, offset);
+        unserialize(texture.width, it->second, offset);
+        unserialize(texture.height, it->second, offset);
+        texture.pixels.assign(it->second.begin() + offset, it->second.end());
+        return true;
+    }
+
+    // info.time is taken as is for the first frame and stored relative to it
+    // info.textures is replaced by the textures recorded with addTexture
+    bool addFrame(const ImDrawData * drawData, const FrameInfo & info = {}) {
+        FrameData frame;
+        serialize(drawData, frame);
+
+        if (frameCount == 0) {
+            startTime = info.time;
+        }
+        FrameInfo relativeInfo = info;
+        relativeInfo.time -= startTime;
+        relativeInfo.textures.clear();
+        for (const auto & [id, hash] : liveTextures) {
+            relativeInfo.textures.push_back({ id, hash });
+        }
+        serialize(relativeInfo, frame);
+
+        frameCount += 1;
+        totalSize += frame.size();
+        if (writer) {
+            writer->push(std::move(frame));
+        } else {
+            frames.emplace_back(std::move(frame));
+        }
+
+        return true;
+    }
+
+    bool getFrame(int32_t fid, ImDrawData* drawData, std::vector<ImDrawList>& drawLists, ImDrawListSharedData* drawListSharedData, FrameInfo* info = nullptr) {
+        const FrameData * frame = findFrame(fid);
+        if (frame == nullptr) return false;
+        if (info && !readFrameInfo(fid, *frame, *info)) return false;
+
+        size_t offset = 0;
+        auto & buf = *frame;
 
         unserialize(drawData->Valid, buf, offset);
         unserialize(drawData->CmdListsCount, buf, offset);
@@ -197,26 +1036,255 @@ struct Session {
         return true;
     }
 
+    // recordings without frame info are assumed to be captured at kDefaultFps and without input
+    bool getFrameInfo(int32_t fid, FrameInfo & info) {
+        const FrameData * frame = findFrame(fid);
+        return frame && readFrameInfo(fid, *frame, info);
+    }
+
+    bool hasFrameInfo() const {
+        return frameInfo;
+    }
+
+    // recorded frames, including the ones already streamed to disk
     int32_t nFrames() const {
-        return frames.size();
+        return frameCount;
     }
 
+    // size of the frames, for loaded v2 files the compressed file size
     uint64_t totalSize_bytes() const {
-        uint64_t result = 0;
+        return totalSize;
+    }
+
+    void printInfo() const {
+        printf("    - Total frames      = %d\n", (int) nFrames());
+        printf("    - Total size        = %d bytes\n", (int) totalSize_bytes());
+    }
+
+    // only the frames kept in memory, empty while streaming or for a loaded file
+    std::vector<FrameData> frames;
+
+private:
+    constexpr static double kDefaultFps = 60.0;
+
+    bool readFrameInfo(int32_t fid, const FrameData & frame, FrameInfo & info) const {
+        if (frameInfo) {
+            return unserialize(info, frame);
+        }
+        info = FrameInfo();
+        info.time = fid / kDefaultFps;
+        return true;
+    }
+
+    const FrameData * findFrame(int32_t fid) {
+        if (fid < 0 || fid >= nFrames()) return nullptr;
+        if (!reader) {
+            return fid < (int32_t) frames.size() ? &frames[fid] : nullptr;
+        }
+
+        const int32_t chunkIdx = reader->findChunk(fid);
+        if (chunkIdx < 0) return nullptr;
+        if (chunkIdx != currentChunkIdx) {
+            // holding the chunk keeps the returned frame alive until the next call
+            currentChunk = reader->getChunk(chunkIdx);
+            currentChunkIdx = currentChunk ? chunkIdx : -1;
+            if (!currentChunk) return nullptr;
+        }
+
+        const uint32_t local = fid - reader->chunkInfo(chunkIdx).firstFrame;
+        return local < currentChunk->size() ? &(*currentChunk)[local] : nullptr;
+    }
+
+    std::unique_ptr<StreamWriter> writer;
+    std::map<uint32_t, uint64_t> liveTextures;
+    std::unordered_set<uint64_t> storedTextures;
+    // texture content by hash while recording into memory
+    std::map<uint64_t, std::vector<char>> textureBlobs;
+    bool frameInfo = true;
+    double startTime = 0.0;
+    std::atomic<int32_t> frameCount{ 0 };
+    std::atomic<uint64_t> totalSize{ 0 };
+
+    // loaded recording
+    std::unique_ptr<ChunkReader> reader;
+    ChunkReader::Chunk currentChunk;
+    int32_t currentChunkIdx = -1;
+};
+
+// keeps the last frames in memory as encoded chunks, bounded by duration and bytes, dump() writes them as a v2 file
+// chunks start with a keyframe, so the oldest one can be dropped as a whole and the rest stays decodable
+struct FlightRecorder {
+    // shorter chunks than a recording, a dropped chunk loses less history
+    constexpr static uint32_t kChunkFrames = 30;
+    constexpr static size_t kChunkSize = 1024*1024;
+
+    FlightRecorder(double maxDuration_s, size_t maxSize_bytes) : maxDuration(maxDuration_s), maxSize(maxSize_bytes) {}
+
+    void addTexture(uint32_t id, int32_t type, int32_t width, int32_t height, const void * pixels, size_t size) {
+        const uint64_t hash = textureHash(type, width, height, pixels, size);
+        liveTextures[id] = hash;
+        if (textures.count(hash)) {
+            return;
+        }
+
+        std::vector<char> texture;
+        serializeTexture(type, width, height, pixels, size, texture);
+        auto & encoded = textures[hash];
+        encoded.rawSize = texture.size();
+        V2::encodeRecord(texture, encoded.stored);
+        storedBytes += encoded.stored.size();
+    }
 
-        for (auto & frame : frames) {
-            result += frame.size();
+    // info.time is kept relative to the first frame the recorder saw, the textures are the ones added with addTexture
+    void addFrame(const ImDrawData * drawData, const FrameInfo & info = {}) {
+        if (!started) {
+            started = true;
+            startTime = info.time;
         }
 
+        FrameData frame;
+        serialize(drawData, frame);
+        FrameInfo relativeInfo = info;
+        relativeInfo.time -= startTime;
+        relativeInfo.textures.clear();
+        for (const auto & [id, hash] : liveTextures) {
+            relativeInfo.textures.push_back({ id, hash });
+            pendingTextures.insert(hash);
+        }
+        serialize(relativeInfo, frame);
+
+        if (encoder.nFrames == 0) {
+            pendingStartTime = relativeInfo.time;
+        }
+        lastTime = relativeInfo.time;
+        encoder.addFrame(frame);
+        if (encoder.isFull(kChunkFrames, kChunkSize)) {
+            seal();
+        }
+        evict();
+    }
+
+    bool dump(const char * fname) {
+        seal();
+
+        std::ofstream fs(fname, std::ios::binary);
+        V2::Writer v2(fs);
+        std::unordered_set<uint64_t> referenced;
+        for (const auto & chunk : chunks) {
+            referenced.insert(chunk.textures.begin(), chunk.textures.end());
+        }
+        for (const auto & [hash, texture] : textures) {
+            if (referenced.count(hash)) {
+                v2.addEncodedTexture(hash, texture.rawSize, texture.stored);
+            }
+        }
+        for (const auto & chunk : chunks) {
+            v2.addEncodedChunk(chunk.nFrames, chunk.rawSize, chunk.stored);
+        }
+        return v2.finish();
+    }
+
+    // held frames, the unsealed ones included
+    int32_t nFrames() const {
+        int32_t result = encoder.nFrames;
+        for (const auto & chunk : chunks) {
+            result += chunk.nFrames;
+        }
         return result;
     }
 
-    void printInfo() const {
-        printf("    - Total frames      = %d\n", (int) frames.size());
-        printf("    - Total size        = %d bytes\n", (int) totalSize_bytes());
+    uint64_t totalSize_bytes() const {
+        return storedBytes + encoder.raw.size();
     }
 
-    std::vector<FrameData> frames;
+    // stored size of the bound textures, these are never evicted so above maxSize the recorder can't stay in budget
+    uint64_t liveTextureSize_bytes() const {
+        std::unordered_set<uint64_t> counted;
+        uint64_t result = 0;
+        for (const auto & [id, hash] : liveTextures) {
+            const auto it = textures.find(hash);
+            if (it != textures.end() && counted.insert(hash).second) {
+                result += it->second.stored.size();
+            }
+        }
+        return result;
+    }
+
+    size_t maxSize_bytes() const { return maxSize; }
+
+private:
+    struct Chunk {
+        std::vector<char> stored;
+        uint32_t rawSize = 0;
+        uint32_t nFrames = 0;
+        double startTime = 0.0;
+        std::vector<uint64_t> textures;
+    };
+
+    struct EncodedTexture {
+        std::vector<char> stored;
+        uint32_t rawSize = 0;
+    };
+
+    void seal() {
+        if (encoder.nFrames == 0) return;
+
+        Chunk chunk;
+        V2::encodeRecord(encoder.raw, chunk.stored);
+        chunk.rawSize = encoder.raw.size();
+        chunk.nFrames = encoder.nFrames;
+        chunk.startTime = pendingStartTime;
+        chunk.textures.assign(pendingTextures.begin(), pendingTextures.end());
+        storedBytes += chunk.stored.size();
+        chunks.emplace_back(std::move(chunk));
+
+        encoder.reset();
+        pendingTextures.clear();
+    }
+
+    void evict() {
+        // the newest sealed chunk stays when over the byte budget, bound textures count against it but can't be evicted
+        bool evicted = false;
+        while (!chunks.empty() && ((chunks.size() > 1 && totalSize_bytes() > maxSize) || lastTime - chunks.front().startTime > maxDuration)) {
+            storedBytes -= chunks.front().stored.size();
+            chunks.pop_front();
+            evicted = true;
+        }
+        if (!evicted) return;
+
+        // drop the textures neither bound nor used by a held frame
+        std::unordered_set<uint64_t> referenced(pendingTextures);
+        for (const auto & chunk : chunks) {
+            referenced.insert(chunk.textures.begin(), chunk.textures.end());
+        }
+        for (const auto & [id, hash] : liveTextures) {
+            referenced.insert(hash);
+        }
+        for (auto it = textures.begin(); it != textures.end();) {
+            if (referenced.count(it->first)) {
+                ++it;
+            } else {
+                storedBytes -= it->second.stored.size();
+                it = textures.erase(it);
+            }
+        }
+    }
+
+    const double maxDuration;
+    const size_t maxSize;
+
+    bool started = false;
+    double startTime = 0.0;
+    double lastTime = 0.0;
+
+    V2::ChunkEncoder encoder;
+    double pendingStartTime = 0.0;
+    std::unordered_set<uint64_t> pendingTextures;
+    std::deque<Chunk> chunks;
+
+    std::map<uint32_t, uint64_t> liveTextures;
+    std::unordered_map<uint64_t, EncodedTexture> textures;
+    size_t storedBytes = 0;
 };
 
 }
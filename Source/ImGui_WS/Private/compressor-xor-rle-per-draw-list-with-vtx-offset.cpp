@@ -82,7 +82,14 @@ XorRlePerDrawListWithVtxOffset::XorRlePerDrawListWithVtxOffset() : m_impl(new Im
 XorRlePerDrawListWithVtxOffset::~XorRlePerDrawListWithVtxOffset() {}
 
 bool XorRlePerDrawListWithVtxOffset::setDrawData(const ::ImDrawData * drawData) {
-    m_drawListsPrev = m_drawListsCur;
+    // the buffers of two frames ago are overwritten below, so swapping is enough to keep the previous frame
+    std::swap(m_drawListsPrev, m_drawListsCur);
+
+    ++m_frameId;
+    const bool isKeyframe = m_keyframeInterval > 0 && m_frameId - m_lastKeyframeId >= m_keyframeInterval;
+    if (isKeyframe) {
+        m_lastKeyframeId = m_frameId;
+    }
 
     uint32_t nCmdLists = drawData->CmdListsCount;
     m_drawListsCur.resize(nCmdLists);
@@ -92,72 +99,17 @@ bool XorRlePerDrawListWithVtxOffset::setDrawData(const ::ImDrawData * drawData)
         ::writeCmdListToBuffer(drawData->CmdLists[iList], m_drawListsCur[iList]);
     }
 
-    return true;
-
-    // calculate diff
+    // new draw lists start at the current frame, the others only move on when their content changed
 
-    m_drawListsDiff.clear();
-    m_drawListsDiff.resize(nCmdLists);
+    m_drawListsRevision.resize(nCmdLists, m_frameId);
 
     for (uint32_t iList = 0; iList < nCmdLists; ++iList) {
-        auto & bufferCur = m_drawListsCur[iList];
-        auto & bufferDiff = m_drawListsDiff[iList];
-
-        bufferDiff.clear();
-
-        int32_t type = 1; // Run-Length Encoding
-        if (iList >= m_drawListsPrev.size() || m_drawListsPrev[iList].size() != bufferCur.size()) {
-            type = 0; // Full update
-        }
+        const auto & bufferCur = m_drawListsCur[iList];
 
-        std::copy((char *)(&type), (char *)(&type) + sizeof(type), std::back_inserter(bufferDiff));
-
-        if (type == 0) {
-            std::copy(bufferCur.begin(), bufferCur.end(), std::back_inserter(bufferDiff));
-        } else if (type == 1) {
-            auto & bufferPrev = m_drawListsPrev[iList];
-
-            uint32_t a = 0;
-            uint32_t b = 0;
-            uint32_t c = 0;
-            uint32_t n = 0;
-
-            for (int i = 0; i < (int) bufferCur.size(); i += 4) {
-                std::memcpy((char *)(&a), bufferPrev.data() + i, sizeof(uint32_t));
-                std::memcpy((char *)(&b), bufferCur.data() + i, sizeof(uint32_t));
-                a = a ^ b;
-                if (a == c) {
-                    ++n;
-                } else {
-                    if (n > 0) {
-                        std::copy((char *)(&n), (char *)(&n) + sizeof(uint32_t), std::back_inserter(bufferDiff));
-                        std::copy((char *)(&c), (char *)(&c) + sizeof(uint32_t), std::back_inserter(bufferDiff));
-                    }
-                    n = 1;
-                    c = a;
-                }
-            }
-
-            if (bufferCur.size() % 4 != 0) {
-                a = 0;
-                b = 0;
-                uint32_t i = (bufferCur.size()/4)*4;
-                uint32_t k = bufferCur.size() - i;
-                std::memcpy((char *)(&a), bufferPrev.data() + i, k);
-                std::memcpy((char *)(&b), bufferCur.data() + i, k);
-                a = a ^ b;
-                if (a == c) {
-                    ++n;
-                } else {
-                    std::copy((char *)(&n), (char *)(&n) + sizeof(uint32_t), std::back_inserter(bufferDiff));
-                    std::copy((char *)(&c), (char *)(&c) + sizeof(uint32_t), std::back_inserter(bufferDiff));
-                    n = 1;
-                    c = a;
-                }
-            }
-
-            std::copy((char *)(&n), (char *)(&n) + sizeof(uint32_t), std::back_inserter(bufferDiff));
-            std::copy((char *)(&c), (char *)(&c) + sizeof(uint32_t), std::back_inserter(bufferDiff));
+        const bool unchanged = !isKeyframe && iList < m_drawListsPrev.size() && m_drawListsPrev[iList].size() == bufferCur.size() &&
+            std::memcmp(m_drawListsPrev[iList].data(), bufferCur.data(), bufferCur.size()) == 0;
+        if (!unchanged) {
+            m_drawListsRevision[iList] = m_frameId;
         }
     }
 
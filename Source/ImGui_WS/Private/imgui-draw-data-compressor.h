@@ -16,36 +16,40 @@ class Interface {
 public:
     using DrawList = std::vector<char>;
     using DrawLists = std::vector<DrawList>;
-    using DrawListDiff = std::vector<char>;
-    using DrawListsDiff = std::vector<DrawListDiff>;
+    using DrawListsRevision = std::vector<uint32_t>;
 
     Interface() {}
     virtual ~Interface() {}
 
     virtual bool setDrawData(const ::ImDrawData * drawData) = 0;
 
-    virtual DrawLists & getDrawLists() {
+    virtual const DrawLists & getDrawLists() const {
         return m_drawListsCur;
     }
 
-    virtual DrawListsDiff & getDrawListsDiff() {
-        return m_drawListsDiff;
+    // frame id at which each draw list last changed
+    virtual const DrawListsRevision & getDrawListsRevision() const {
+        return m_drawListsRevision;
     }
 
-    virtual uint64_t diffSize() const {
-        uint64_t res = 0;
-
-        for (auto & list : m_drawListsDiff) {
-            res += list.size();
-        }
+    // id of the last frame passed to setDrawData, starts at 1
+    virtual uint32_t frameId() const {
+        return m_frameId;
+    }
 
-        return res;
+    // bump every draw list revision each n frames, 0 only bumps changed ones
+    virtual void setKeyframeInterval(uint32_t n) {
+        m_keyframeInterval = n;
     }
 
 protected:
     DrawLists m_drawListsCur;
     DrawLists m_drawListsPrev;
-    DrawListsDiff m_drawListsDiff;
+    DrawListsRevision m_drawListsRevision;
+
+    uint32_t m_frameId = 0;
+    uint32_t m_lastKeyframeId = 0;
+    uint32_t m_keyframeInterval = 0;
 };
 
 class XorRlePerDrawListWithVtxOffset : public Interface {
@@ -16,7 +16,233 @@
 #include "imgui.h"
 #include "Incppect.h"
 #include "UnrealImGui_Log.h"
+#include "Async/Async.h"
 #include "Containers/Queue.h"
+#include "Hash/xxhash.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+    // binary input, little endian: [uint8 tag][uint8 event type][2 bytes padding][fields]
+    // the tag can't start a legacy text message, those begin with the event type digits
+    constexpr uint8 BinaryInputTag = 0x81;
+
+    // shares the id space of ServerEventType in imgui-ws.js with the manager's events, payload: [uint32 texture id]
+    constexpr int32 ServerEventRemoveTexture = 1;
+
+    void ReadBinaryInput(TArrayView<const uint8> Data, ImGuiWS::FEvent& Event)
+    {
+        using FEvent = ImGuiWS::FEvent;
+
+        int32 Offset = 4;
+        bool bValid = true;
+        auto Read = [&](auto& Value)
+        {
+            if (Offset + (int32)sizeof(Value) > Data.Num())
+            {
+                bValid = false;
+                return;
+            }
+            FMemory::Memcpy(&Value, Data.GetData() + Offset, sizeof(Value));
+            Offset += sizeof(Value);
+        };
+        auto ReadText = [&](std::string& Text)
+        {
+            // utf8 text till the end of the message
+            Text.assign(reinterpret_cast<const char*>(Data.GetData()) + Offset, Data.Num() - Offset);
+        };
+
+        Event.Type = static_cast<FEvent::EType>(Data[1]);
+        switch (Event.Type)
+        {
+            case FEvent::MouseMove:
+                Read(Event.MouseX); Read(Event.MouseY);
+                break;
+            case FEvent::MouseDown:
+            case FEvent::MouseUp:
+                Read(Event.MouseBtn); Read(Event.MouseX); Read(Event.MouseY);
+                break;
+            case FEvent::MouseWheel:
+                Read(Event.WheelX); Read(Event.WheelY);
+                break;
+            case FEvent::KeyPress:
+            case FEvent::KeyDown:
+            case FEvent::KeyUp:
+                Read(Event.Key);
+                break;
+            case FEvent::Resize:
+                Read(Event.ClientWidth); Read(Event.ClientHeight);
+                break;
+            case FEvent::TakeControl:
+                break;
+            case FEvent::PasteClipboard:
+                ReadText(Event.ClipboardText);
+                break;
+            case FEvent::InputText:
+                ReadText(Event.InputtedText);
+                break;
+            case FEvent::ReplayControl:
+                Read(Event.ReplayCommand); Read(Event.ReplayFrame);
+                break;
+            default:
+                bValid = false;
+                break;
+        }
+
+        if (bValid == false)
+        {
+            UE_LOG(LogImGui, Warning, TEXT("Invalid binary input received from client: id = %d, type = %d, size = %d"), Event.ClientId, Data[1], Data.Num());
+            Event.Type = FEvent::Unknown;
+        }
+    }
+
+    int32 GetBytesPerPixel(ImGuiWS::FTexture::Type TextureType)
+    {
+        switch (TextureType)
+        {
+            case ImGuiWS::FTexture::Type::RGB24:  return 3;
+            case ImGuiWS::FTexture::Type::RGBA32: return 4;
+            default:                              return 1;
+        }
+    }
+
+    // PNG, or JPEG for opaque textures when LossyQuality is set, the raw Data when the encoding isn't smaller
+    // runs on the thread pool, the texture is a snapshot sharing the immutable Data
+    FIncppect::TBlob EncodeTextureData(IImageWrapperModule& ImageWrapperModule, const ImGuiWS::FTexture& Texture, bool bLossless, int32 LossyQuality)
+    {
+        using FTexture = ImGuiWS::FTexture;
+
+        const TArrayView<const uint8> Pixels = Texture.GetPixels();
+        const int32 NumPixels = Texture.Width * Texture.Height;
+
+        // the browser decodes to rgba, expanded like imgui-ws.js does for raw textures
+        TArray<uint8> Rgba;
+        ERGBFormat Format = ERGBFormat::RGBA;
+        bool bOpaque = true;
+        switch (Texture.TextureType)
+        {
+            case FTexture::Type::Alpha8:
+                bOpaque = false;
+                Rgba.SetNumUninitialized(NumPixels * 4);
+                for (int32 Idx = 0; Idx < NumPixels; ++Idx)
+                {
+                    Rgba[Idx * 4 + 0] = Rgba[Idx * 4 + 1] = Rgba[Idx * 4 + 2] = 0xFF;
+                    Rgba[Idx * 4 + 3] = Pixels[Idx];
+                }
+                break;
+            case FTexture::Type::Gray8:
+                Format = ERGBFormat::Gray;
+                break;
+            case FTexture::Type::RGB24:
+                Rgba.SetNumUninitialized(NumPixels * 4);
+                for (int32 Idx = 0; Idx < NumPixels; ++Idx)
+                {
+                    FMemory::Memcpy(&Rgba[Idx * 4], &Pixels[Idx * 3], 3);
+                    Rgba[Idx * 4 + 3] = 0xFF;
+                }
+                break;
+            case FTexture::Type::RGBA32:
+                for (int32 Idx = 0; Idx < NumPixels && bOpaque; ++Idx)
+                {
+                    bOpaque = Pixels[Idx * 4 + 3] == 0xFF;
+                }
+                break;
+        }
+        const TArrayView<const uint8> Raw = Rgba.Num() > 0 ? TArrayView<const uint8>(Rgba) : Pixels;
+
+        // JPEG has no alpha
+        const bool bLossy = LossyQuality > 0 && bOpaque;
+        if (bLossy == false && bLossless == false)
+        {
+            return Texture.Data;
+        }
+        const TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(bLossy ? EImageFormat::JPEG : EImageFormat::PNG);
+        if (ImageWrapper.IsValid() == false || ImageWrapper->SetRaw(Raw.GetData(), Raw.Num(), Texture.Width, Texture.Height, Format, 8) == false)
+        {
+            return Texture.Data;
+        }
+        const TArray64<uint8> Encoded = ImageWrapper->GetCompressed(bLossy ? FMath::Clamp(LossyQuality, 1, 100) : 0);
+        // noise doesn't compress, it stays raw
+        if (Encoded.Num() == 0 || Encoded.Num() >= Pixels.Num())
+        {
+            return Texture.Data;
+        }
+
+        const FTexture::Codec Codec = bLossy ? FTexture::Codec::JPEG : FTexture::Codec::PNG;
+        const int32 PayloadSize = Encoded.Num();
+        constexpr int32 CodecOffset = FTexture::HeaderSize - sizeof(FTexture::Codec) - sizeof(int32);
+        TArray<uint8> WireData;
+        WireData.Reserve(FTexture::HeaderSize + PayloadSize);
+        WireData.Append(Texture.Data->GetData(), CodecOffset);
+        WireData.Append(reinterpret_cast<const uint8*>(&Codec), sizeof(Codec));
+        WireData.Append(reinterpret_cast<const uint8*>(&PayloadSize), sizeof(PayloadSize));
+        WireData.Append(Encoded.GetData(), PayloadSize);
+        return MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(WireData));
+    }
+
+    // dirty tiles between two revisions of the same size and type:
+    //   [int32 base revision][int32 revision][int32 n tiles][tile...]
+    //   tile: [int32 x][int32 y][int32 width][int32 height][pixels, padded to 4 bytes]
+    // returns false when more than MaxDirtyRatio of the tiles changed, the full texture is cheaper then
+    constexpr int32 TextureTileSize = 64;
+
+    bool MakeTexturePatch(const ImGuiWS::FTexture& Prev, const ImGuiWS::FTexture& Cur, float MaxDirtyRatio, TArray<uint8>& OutPatch)
+    {
+        const int32 Bpp = GetBytesPerPixel(Cur.TextureType);
+        const int32 Pitch = Cur.Width * Bpp;
+        const uint8* PrevPixels = Prev.GetPixels().GetData();
+        const uint8* CurPixels = Cur.GetPixels().GetData();
+        const int32 NumTilesX = FMath::DivideAndRoundUp(Cur.Width, TextureTileSize);
+        const int32 NumTilesY = FMath::DivideAndRoundUp(Cur.Height, TextureTileSize);
+        const int32 MaxDirtyTiles = FMath::FloorToInt32(NumTilesX * NumTilesY * MaxDirtyRatio);
+
+        TArray<FIntRect, TInlineAllocator<64>> DirtyTiles;
+        for (int32 TileY = 0; TileY < NumTilesY; ++TileY)
+        {
+            for (int32 TileX = 0; TileX < NumTilesX; ++TileX)
+            {
+                const FIntRect Tile{ TileX * TextureTileSize, TileY * TextureTileSize, FMath::Min((TileX + 1) * TextureTileSize, Cur.Width), FMath::Min((TileY + 1) * TextureTileSize, Cur.Height) };
+                for (int32 Y = Tile.Min.Y; Y < Tile.Max.Y; ++Y)
+                {
+                    const int32 RowOffset = Y * Pitch + Tile.Min.X * Bpp;
+                    if (FMemory::Memcmp(PrevPixels + RowOffset, CurPixels + RowOffset, Tile.Width() * Bpp) != 0)
+                    {
+                        DirtyTiles.Add(Tile);
+                        break;
+                    }
+                }
+                if (DirtyTiles.Num() > MaxDirtyTiles)
+                {
+                    return false;
+                }
+            }
+        }
+
+        auto Write = [&OutPatch](int32 Value)
+        {
+            OutPatch.Append(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+        };
+        OutPatch.Reset();
+        Write(Prev.Revision);
+        Write(Cur.Revision);
+        Write(DirtyTiles.Num());
+        for (const FIntRect& Tile : DirtyTiles)
+        {
+            Write(Tile.Min.X);
+            Write(Tile.Min.Y);
+            Write(Tile.Width());
+            Write(Tile.Height());
+            for (int32 Y = Tile.Min.Y; Y < Tile.Max.Y; ++Y)
+            {
+                OutPatch.Append(CurPixels + Y * Pitch + Tile.Min.X * Bpp, Tile.Width() * Bpp);
+            }
+            OutPatch.AddZeroed(Align(OutPatch.Num(), 4) - OutPatch.Num());
+        }
+        return true;
+    }
+}
 
 struct ImGuiWS::FImpl
 {
@@ -30,14 +256,19 @@ struct ImGuiWS::FImpl
         : DrawInfo()
         , CompressorDrawData(new ImDrawDataCompressor::XorRlePerDrawListWithVtxOffset())
     {
+        Waker->Incpp = &Incpp;
     }
 
     std::atomic<int32> NumConnected = 0;
+    TSet<int32> ClientIds;
 
-    TMap<int32, FTextureId> TextureIdMap;
+    // dense list behind imgui.texture_id[%d], removal swaps the last id into the hole
+    TArray<FTextureId> TextureIds;
+    TMap<FTextureId, int32> TextureIdIndices;
     TMap<FTextureId, FTexture> Textures;
 
-    ImDrawDataCompressor::Interface::DrawLists DrawLists;
+    // immutable per draw list payloads, unchanged draw lists keep their blob
+    TArray<FIncppect::TBlob> DrawLists;
     FDrawInfo DrawInfo;
 
     TQueue<FEvent> Events;
@@ -51,6 +282,158 @@ struct ImGuiWS::FImpl
 
     using FAsyncTask = TFunction<void(FImpl&)>;
     TQueue<FAsyncTask> AsyncTasks;
+
+    FTextureHandler TextureHandler;
+
+    // dirty tile patches of the latest revisions, oldest first, each one updates the previous revision
+    // clients further behind than the kept patches fetch the full texture
+    struct FTexturePatches
+    {
+        TArray<TArray<uint8>> Patches;
+        int32 PatchesSize = 0;
+        // [int32 id][int32 revision][int32 n patches][patch...]
+        FIncppect::TBlob Blob;
+    };
+    TMap<FTextureId, FTexturePatches> TexturePatches;
+    float TextureMaxDirtyRatio = 0.5f;
+
+    FTextureCompression TextureCompression;
+    IImageWrapperModule* ImageWrapperModule = nullptr;
+    struct FTextureEncoding
+    {
+        // at most one encoding per texture is in flight, the latest revision is encoded once it is done
+        int32 InFlightRevision = 0;
+        double LastRevisionTime = -1.0;
+        // updated again within a second, a live preview rather than an asset
+        bool bLive = false;
+    };
+    TMap<FTextureId, FTextureEncoding> TextureEncodings;
+    struct FEncodedTexture
+    {
+        FTextureId TextureId;
+        int32 Revision;
+        FIncppect::TBlob WireData;
+    };
+    // shared with the encoding tasks, results arriving after the server is gone are dropped with it
+    TSharedRef<TQueue<FEncodedTexture, EQueueMode::Mpsc>, ESPMode::ThreadSafe> EncodedTextures = MakeShared<TQueue<FEncodedTexture, EQueueMode::Mpsc>, ESPMode::ThreadSafe>();
+    // wakes the server thread up once an encoding is done, the tasks only hold a weak reference
+    struct FWaker
+    {
+        FCriticalSection CriticalSection;
+        FIncppect* Incpp = nullptr;
+
+        void WakeUp()
+        {
+            FScopeLock ScopeLock{ &CriticalSection };
+            if (Incpp)
+            {
+                Incpp->WakeUp();
+            }
+        }
+        void Detach()
+        {
+            FScopeLock ScopeLock{ &CriticalSection };
+            Incpp = nullptr;
+        }
+    };
+    TSharedPtr<FWaker, ESPMode::ThreadSafe> Waker = MakeShared<FWaker, ESPMode::ThreadSafe>();
+
+    // returns whether the texture is live
+    bool UpdateTextureLiveness(FTextureId TextureId)
+    {
+        FTextureEncoding& Encoding = TextureEncodings.FindOrAdd(TextureId);
+        const double Now = FPlatformTime::Seconds();
+        Encoding.bLive = Encoding.LastRevisionTime >= 0.0 && Now - Encoding.LastRevisionTime < 1.0;
+        Encoding.LastRevisionTime = Now;
+        return Encoding.bLive;
+    }
+
+    void UpdateTextureWireData(FTextureId TextureId, FTexture& Texture)
+    {
+        FTextureEncoding& Encoding = TextureEncodings.FindOrAdd(TextureId);
+        const bool bEncode = TextureCompression.bLossless || (Encoding.bLive && TextureCompression.LossyQuality > 0);
+        if (ImageWrapperModule == nullptr || bEncode == false || Texture.GetPixels().Num() < TextureCompression.MinEncodeSize)
+        {
+            Texture.WireData = Texture.Data;
+            return;
+        }
+        if (Encoding.InFlightRevision == 0)
+        {
+            EncodeTexture(TextureId, Texture, Encoding);
+        }
+    }
+
+    void EncodeTexture(FTextureId TextureId, const FTexture& Texture, FTextureEncoding& Encoding)
+    {
+        Encoding.InFlightRevision = Texture.Revision;
+        const bool bLossless = TextureCompression.bLossless;
+        const int32 LossyQuality = Encoding.bLive ? TextureCompression.LossyQuality : 0;
+        Async(EAsyncExecution::ThreadPool, [TextureId, Texture, bLossless, LossyQuality, ImageWrapperModule = ImageWrapperModule, Results = EncodedTextures, WeakWaker = TWeakPtr<FWaker, ESPMode::ThreadSafe>(Waker)]
+        {
+            Results->Enqueue({ TextureId, Texture.Revision, EncodeTextureData(*ImageWrapperModule, Texture, bLossless, LossyQuality) });
+            if (const TSharedPtr<FWaker, ESPMode::ThreadSafe> PinnedWaker = WeakWaker.Pin())
+            {
+                PinnedWaker->WakeUp();
+            }
+        });
+    }
+
+    void ApplyEncodedTextures()
+    {
+        FEncodedTexture Encoded;
+        while (EncodedTextures->Dequeue(Encoded))
+        {
+            FTexture* Texture = Textures.Find(Encoded.TextureId);
+            FTextureEncoding* Encoding = TextureEncodings.Find(Encoded.TextureId);
+            if (Texture == nullptr || Encoding == nullptr)
+            {
+                // removed meanwhile
+                continue;
+            }
+            Encoding->InFlightRevision = 0;
+            Texture->WireData = MoveTemp(Encoded.WireData);
+            if (Texture->Revision != Encoded.Revision)
+            {
+                EncodeTexture(Encoded.TextureId, *Texture, *Encoding);
+            }
+        }
+    }
+
+    void UpdateTexturePatches(FTextureId TextureId, const FTexture& Prev, const FTexture& Cur)
+    {
+        FTexturePatches& History = TexturePatches.FindOrAdd(TextureId);
+        const bool bSameLayout = Prev.Data.IsValid() && Prev.TextureType == Cur.TextureType && Prev.Width == Cur.Width && Prev.Height == Cur.Height;
+        TArray<uint8> Patch;
+        if (bSameLayout && MakeTexturePatch(Prev, Cur, TextureMaxDirtyRatio, Patch))
+        {
+            History.PatchesSize += Patch.Num();
+            History.Patches.Add(MoveTemp(Patch));
+            // the patches together stay below the same share of a full resend
+            const int32 MaxPatchesSize = FMath::FloorToInt32(Cur.GetPixels().Num() * TextureMaxDirtyRatio);
+            while (History.Patches.Num() > 1 && History.PatchesSize > MaxPatchesSize)
+            {
+                History.PatchesSize -= History.Patches[0].Num();
+                History.Patches.RemoveAt(0);
+            }
+        }
+        else
+        {
+            History.Patches.Empty();
+            History.PatchesSize = 0;
+        }
+
+        TArray<uint8> Blob;
+        Blob.Reserve(3 * sizeof(int32) + History.PatchesSize);
+        const int32 NumPatches = History.Patches.Num();
+        Blob.Append(reinterpret_cast<const uint8*>(&TextureId), sizeof(TextureId));
+        Blob.Append(reinterpret_cast<const uint8*>(&Cur.Revision), sizeof(Cur.Revision));
+        Blob.Append(reinterpret_cast<const uint8*>(&NumPatches), sizeof(NumPatches));
+        for (const TArray<uint8>& Entry : History.Patches)
+        {
+            Blob.Append(Entry);
+        }
+        History.Blob = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Blob));
+    }
 };
 
 ImGuiWS::ImGuiWS()
@@ -59,6 +442,7 @@ ImGuiWS::ImGuiWS()
 
 ImGuiWS::~ImGuiWS()
 {
+    Impl->Waker->Detach();
     Impl->Incpp.Stop();
 }
 
@@ -73,9 +457,10 @@ void ImGuiWS::AddServerEvent(int32 ClientId, int32 EventId, TArray<uint8>&& Payl
     {
         ImplRef.Incpp.ServerEvent(ClientId, EventId, MoveTemp(Payload));
     });
+    Impl->Incpp.WakeUp();
 }
 
-bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
+bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk, const FCompression& Compression)
 {
     // start the http/websocket server
     FIncppect::FParameters Parameters;
@@ -83,7 +468,12 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
     Parameters.tLastRequestTimeout_ms = -1;
     Parameters.HttpRoot = TEXT("/");
     Parameters.PathOnDisk = PathOnDisk;
+    Parameters.DeflateLevel = Compression.DeflateLevel;
+    Parameters.bLZ4Frame = Compression.bLZ4Frame;
+    Parameters.MinCompressMessageSize = Compression.MinCompressMessageSize;
     Impl->Incpp.Init(Parameters);
+    // loaded here, the encoding tasks can't load modules
+    Impl->ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
 
     Impl->Incpp.Var(TEXT("my_id[%d]"), [](const auto& idxs)
     {
@@ -95,7 +485,7 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
     // number of textures available
     Impl->Incpp.Var(TEXT("imgui.n_textures"), [this](const auto& )
     {
-        return FIncppect::view(Impl->Textures.Num());
+        return FIncppect::view(Impl->TextureIds.Num());
     });
 
     // sync mouse cursor
@@ -141,9 +531,9 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
     // texture ids
     Impl->Incpp.Var(TEXT("imgui.texture_id[%d]"), [this](const auto& idxs)
     {
-        if (const FTextureId* Idx = Impl->TextureIdMap.Find(idxs[0]))
+        if (Impl->TextureIds.IsValidIndex(idxs[0]))
         {
-            return FIncppect::view(*Idx);
+            return FIncppect::view(Impl->TextureIds[idxs[0]]);
         }
         return std::string_view{ };
     });
@@ -158,15 +548,34 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
         return std::string_view { };
     });
 
-    // get texture by id
-    Impl->Incpp.Var(TEXT("imgui.texture_data[%d]"), [this](const auto& idxs)
+    // content hash of the texture revision, clients holding it in their cache don't request the texture data
+    Impl->Incpp.Var(TEXT("imgui.texture_hash[%d]"), [this](const auto& idxs)
+    {
+        if (const FTexture* Texture = Impl->Textures.Find(idxs[0]))
+        {
+            return FIncppect::view(Texture->Hash);
+        }
+        return std::string_view { };
+    });
+
+    // get texture by id, streamed so a large texture doesn't hold back the draw lists
+    Impl->Incpp.StreamVar(TEXT("imgui.texture_data[%d]"), [this](const auto& idxs) -> FIncppect::FResult
     {
         const auto TextureId = idxs[0];
-        if (const FTexture* Texture = Impl->Textures.Find(TextureId))
+        const FTexture* Texture = Impl->Textures.Find(TextureId);
+        if (Texture && Texture->WireData.IsValid())
+        {
+            return Texture->WireData;
+        }
+        return std::string_view { nullptr, 0 };
+    });
+
+    // dirty tiles of the latest revisions, clients holding an older revision apply them instead of the full texture
+    Impl->Incpp.Var(TEXT("imgui.texture_patches[%d]"), [this](const auto& idxs) -> FIncppect::FResult
+    {
+        if (const FImpl::FTexturePatches* Patches = Impl->TexturePatches.Find(idxs[0]))
         {
-            static TArray<uint8> Data;
-            Data = Texture->Data;
-            return std::string_view { reinterpret_cast<char*>(Data.GetData()), (uint32)Data.Num() };
+            return Patches->Blob;
         }
         return std::string_view { nullptr, 0 };
     });
@@ -174,25 +583,27 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
     // get imgui's draw data
     Impl->Incpp.Var(TEXT("imgui.n_draw_lists"), [this](const auto& )
     {
-        return FIncppect::view(Impl->DrawLists.size());
+        return FIncppect::view(static_cast<size_t>(Impl->DrawLists.Num()));
     });
 
-    Impl->Incpp.Var(TEXT("imgui.draw_list[%d]"), [this](const auto& idxs)
+    // revision of each draw list, clients only request draw lists whose revision they don't hold
+    Impl->Incpp.Var(TEXT("imgui.draw_list_revision[%d]"), [this](const auto& idxs)
     {
-        static std::vector<char> data;
+        const auto& Revisions = Impl->CompressorDrawData->getDrawListsRevision();
+        if (idxs[0] >= (int32) Revisions.size())
         {
-            if (idxs[0] >= (int32) Impl->DrawLists.size())
-            {
-                return std::string_view { nullptr, 0 };
-            }
-
-            data.clear();
-            std::copy(Impl->DrawLists[idxs[0]].data(),
-                      Impl->DrawLists[idxs[0]].data() + Impl->DrawLists[idxs[0]].size(),
-                      std::back_inserter(data));
+            return std::string_view { nullptr, 0 };
         }
+        return FIncppect::view(Revisions[idxs[0]]);
+    });
 
-        return std::string_view { data.data(), data.size() };
+    Impl->Incpp.Var(TEXT("imgui.draw_list[%d]"), [this](const auto& idxs) -> FIncppect::FResult
+    {
+        if (Impl->DrawLists.IsValidIndex(idxs[0]) == false)
+        {
+            return std::string_view { nullptr, 0 };
+        }
+        return Impl->DrawLists[idxs[0]];
     });
 
     Impl->Incpp.SetHandler([&](int32 ClientId, FIncppect::EventType EventType, TArrayView<const uint8> Data)
@@ -206,6 +617,7 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
             case FIncppect::Connect:
                 {
                     Impl->NumConnected += 1;
+                    Impl->ClientIds.Add(ClientId);
                     Event.Type = FEvent::Connected;
                     Event.Ip = Data[0] + (Data[1] << 8) + (Data[2] << 16) + (Data[3] << 24);
                     if (Impl->HandlerConnect)
@@ -217,6 +629,7 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
             case FIncppect::Disconnect:
                 {
                     Impl->NumConnected -= 1;
+                    Impl->ClientIds.Remove(ClientId);
                     Event.Type = FEvent::Disconnected;
                     if (Impl->HandlerDisconnect)
                     {
@@ -226,6 +639,13 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
                 break;
             case FIncppect::Custom:
                 {
+                    if (Data.Num() >= 4 && Data[0] == BinaryInputTag)
+                    {
+                        ReadBinaryInput(Data, Event);
+                        break;
+                    }
+
+                    // legacy text input: "type args..."
                     std::stringstream ss;
                     ss << reinterpret_cast<const char*>(Data.GetData());
 
@@ -290,6 +710,11 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
                                 ss >> Event.InputtedText;
                             }
                             break;
+                        case FEvent::ReplayControl:
+                            {
+                                ss >> Event.ReplayCommand >> Event.ReplayFrame;
+                            }
+                            break;
                         default:
                             {
                                 Event.Type = FEvent::Unknown;
@@ -316,7 +741,7 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk, THandler&& Handl
     return Init(PortListen, PathOnDisk);
 }
 
-void ImGuiWS::Tick()
+void ImGuiWS::Tick(int32 TimeoutMs)
 {
     while (Impl->AsyncTasks.IsEmpty() == false)
     {
@@ -324,21 +749,20 @@ void ImGuiWS::Tick()
         Impl->AsyncTasks.Dequeue(Task);
         Task(*Impl);
     }
-    Impl->Incpp.Tick();
+    Impl->ApplyEncodedTextures();
+    Impl->Incpp.Tick(TimeoutMs);
+}
+
+void ImGuiWS::WakeUp()
+{
+    Impl->Incpp.WakeUp();
 }
 
 bool ImGuiWS::SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32 Width, int32 Height, const uint8* Data)
 {
-    int32 bpp = 1; // bytes per pixel
-    switch (TextureType)
-    {
-        case FTexture::Type::Alpha8: bpp = 1; break;
-        case FTexture::Type::Gray8:  bpp = 1; break;
-        case FTexture::Type::RGB24:  bpp = 3; break;
-        case FTexture::Type::RGBA32: bpp = 4; break;
-    }
+    const int32 bpp = GetBytesPerPixel(TextureType);
     TArray<uint8> TextureData;
-    TextureData.SetNumUninitialized(sizeof(FTextureId) + sizeof(FTexture::Type) + 3*sizeof(int32) + bpp*Width*Height);
+    TextureData.SetNumUninitialized(FTexture::HeaderSize + bpp*Width*Height);
 
     size_t Offset = 0;
     FMemory::Memcpy(TextureData.GetData() + Offset, &TextureId, sizeof(TextureId)); Offset += sizeof(TextureId);
@@ -346,45 +770,150 @@ bool ImGuiWS::SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32
     FMemory::Memcpy(TextureData.GetData() + Offset, &Width, sizeof(Width)); Offset += sizeof(Width);
     FMemory::Memcpy(TextureData.GetData() + Offset, &Height, sizeof(Height)); Offset += sizeof(Height);
     const int32 RevisionOffset = Offset; Offset += sizeof(int32);
-    FMemory::Memcpy(TextureData.GetData() + Offset, Data, bpp*Width*Height);
-
-    Impl->AsyncTasks.Enqueue([TextureId, TextureData = MoveTemp(TextureData), RevisionOffset](FImpl& ImplRef) mutable
+    const FTexture::Codec Codec = FTexture::Codec::Raw;
+    const int32 PayloadSize = bpp*Width*Height;
+    const int32 HashOffset = Offset; Offset += sizeof(uint64);
+    FMemory::Memcpy(TextureData.GetData() + Offset, &Codec, sizeof(Codec)); Offset += sizeof(Codec);
+    FMemory::Memcpy(TextureData.GetData() + Offset, &PayloadSize, sizeof(PayloadSize)); Offset += sizeof(PayloadSize);
+    FMemory::Memcpy(TextureData.GetData() + Offset, Data, PayloadSize);
+
+    Impl->AsyncTasks.Enqueue([TextureId, TextureType, Width, Height, TextureData = MoveTemp(TextureData), RevisionOffset, HashOffset, PayloadSize](FImpl& ImplRef) mutable
     {
         FTexture& Texture = ImplRef.Textures.FindOrAdd(TextureId);
         if (Texture.Revision == 0)
         {
-            ImplRef.TextureIdMap.Empty();
-            int32 Idx = 0;
-            for (const auto& [Id, _] : ImplRef.Textures)
-            {
-                ImplRef.TextureIdMap.Add(Idx, Id);
-                Idx += 1;
-            }
+            ImplRef.TextureIdIndices.Add(TextureId, ImplRef.TextureIds.Add(TextureId));
         }
+        const FTexture PrevTexture = Texture;
         Texture.Revision++;
         const int32 Revision = Texture.Revision;
 
-        Texture.Data = MoveTemp(TextureData);
-        FMemory::Memcpy(Texture.Data.GetData() + RevisionOffset, &Revision, sizeof(Revision));
+        FMemory::Memcpy(TextureData.GetData() + RevisionOffset, &Revision, sizeof(Revision));
+        // live textures change too often for the browser cache to hit, they skip hashing
+        Texture.Hash = 0;
+        if (ImplRef.UpdateTextureLiveness(TextureId) == false)
+        {
+            FXxHash64Builder HashBuilder;
+            HashBuilder.Update(&TextureType, sizeof(TextureType));
+            HashBuilder.Update(&Width, sizeof(Width));
+            HashBuilder.Update(&Height, sizeof(Height));
+            HashBuilder.Update(TextureData.GetData() + FTexture::HeaderSize, PayloadSize);
+            // 0 is reserved for textures that aren't cached
+            Texture.Hash = FMath::Max<uint64>(HashBuilder.Finalize().Hash, 1);
+        }
+        FMemory::Memcpy(TextureData.GetData() + HashOffset, &Texture.Hash, sizeof(Texture.Hash));
+        Texture.TextureType = TextureType;
+        Texture.Width = Width;
+        Texture.Height = Height;
+        Texture.Data = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(TextureData));
+        ImplRef.UpdateTexturePatches(TextureId, PrevTexture, Texture);
+        ImplRef.UpdateTextureWireData(TextureId, Texture);
+
+        if (ImplRef.TextureHandler)
+        {
+            ImplRef.TextureHandler(TextureId, Texture);
+        }
     });
+    Impl->Incpp.WakeUp();
 
     return true;
 }
 
+void ImGuiWS::RemoveTexture(FTextureId TextureId)
+{
+    Impl->AsyncTasks.Enqueue([TextureId](FImpl& ImplRef)
+    {
+        if (ImplRef.Textures.Remove(TextureId) == 0)
+        {
+            return;
+        }
+        ImplRef.TexturePatches.Remove(TextureId);
+        ImplRef.TextureEncodings.Remove(TextureId);
+
+        int32 Idx;
+        if (ImplRef.TextureIdIndices.RemoveAndCopyValue(TextureId, Idx))
+        {
+            ImplRef.TextureIds.RemoveAtSwap(Idx);
+            if (ImplRef.TextureIds.IsValidIndex(Idx))
+            {
+                ImplRef.TextureIdIndices[ImplRef.TextureIds[Idx]] = Idx;
+            }
+        }
+
+        for (const int32 ClientId : ImplRef.ClientIds)
+        {
+            TArray<uint8> Payload;
+            Payload.Append(reinterpret_cast<const uint8*>(&TextureId), sizeof(TextureId));
+            ImplRef.Incpp.ServerEvent(ClientId, ServerEventRemoveTexture, MoveTemp(Payload));
+        }
+    });
+    Impl->Incpp.WakeUp();
+}
+
+void ImGuiWS::SetTextureHandler(FTextureHandler&& Handler)
+{
+    Impl->TextureHandler = MoveTemp(Handler);
+}
+
+void ImGuiWS::ForEachTexture(const FTextureHandler& Handler) const
+{
+    for (const auto& [TextureId, Texture] : Impl->Textures)
+    {
+        Handler(TextureId, Texture);
+    }
+}
+
 bool ImGuiWS::SetDrawData(const ImDrawData* DrawData)
 {
     bool Result = true;
 
     Result &= Impl->CompressorDrawData->setDrawData(DrawData);
 
-    auto& DrawLists = Impl->CompressorDrawData->getDrawLists();
+    const auto& DrawLists = Impl->CompressorDrawData->getDrawLists();
+    const auto& Revisions = Impl->CompressorDrawData->getDrawListsRevision();
+    const uint32 FrameId = Impl->CompressorDrawData->frameId();
+
+    // make the draw lists available to incppect clients, each payload is prefixed with its revision
+    // unchanged draw lists keep the blob of the previous frame, clients may still be sending it
+    Impl->DrawLists.SetNum(DrawLists.size());
+    for (int32 Idx = 0; Idx < (int32) DrawLists.size(); ++Idx)
+    {
+        if (Revisions[Idx] != FrameId && Impl->DrawLists[Idx].IsValid())
+        {
+            continue;
+        }
 
-    // make the draw lists available to incppect clients
-    Impl->DrawLists = MoveTemp(DrawLists);
+        TArray<uint8> Payload;
+        Payload.SetNumUninitialized(sizeof(uint32) + DrawLists[Idx].size());
+        FMemory::Memcpy(Payload.GetData(), &Revisions[Idx], sizeof(uint32));
+        FMemory::Memcpy(Payload.GetData() + sizeof(uint32), DrawLists[Idx].data(), DrawLists[Idx].size());
+        Impl->DrawLists[Idx] = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Payload));
+    }
 
     return Result;
 }
 
+void ImGuiWS::SetDrawDataKeyframeInterval(int32 Interval)
+{
+    Impl->CompressorDrawData->setKeyframeInterval(FMath::Max(Interval, 0));
+}
+
+void ImGuiWS::SetTextureMaxDirtyRatio(float Ratio)
+{
+    Impl->AsyncTasks.Enqueue([Ratio = FMath::Clamp(Ratio, 0.f, 1.f)](FImpl& ImplRef)
+    {
+        ImplRef.TextureMaxDirtyRatio = Ratio;
+    });
+}
+
+void ImGuiWS::SetTextureCompression(const FTextureCompression& Compression)
+{
+    Impl->AsyncTasks.Enqueue([Compression](FImpl& ImplRef)
+    {
+        ImplRef.TextureCompression = Compression;
+    });
+}
+
 void ImGuiWS::SetDrawInfo(const FDrawInfo& DrawInfo)
 {
     Impl->DrawInfo = DrawInfo;
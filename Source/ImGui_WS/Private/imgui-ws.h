@@ -30,9 +30,35 @@ public:
             RGBA32 = 3,
         };
 
+        enum class Codec : int32
+        {
+            Raw  = 0,
+            PNG  = 1,
+            JPEG = 2,
+        };
+
+        // Data starts with [id][type][width][height][revision][uint64 hash][codec][payload size], the raw pixels follow
+        static constexpr int32 HeaderSize = sizeof(FTextureId) + sizeof(Type) + 3*sizeof(int32) + sizeof(uint64) + sizeof(Codec) + sizeof(int32);
+
         int32 Revision = 0;
-        TArray<uint8> Data;
+        // content hash of the type, size and pixels, clients cache textures by it
+        // 0 for live textures updated again within a second, they aren't worth caching
+        uint64 Hash = 0;
+        Type TextureType = Type::Alpha8;
+        int32 Width = 0;
+        int32 Height = 0;
+        // immutable snapshot, replaced as a whole on every SetTexture
+        TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Data;
+        // sent to the clients, Data itself or the same header followed by an encoded image
+        // lags behind Data while the latest revision is being encoded, empty until the first one is done
+        TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> WireData;
+
+        TArrayView<const uint8> GetPixels() const
+        {
+            return Data.IsValid() ? TArrayView<const uint8>(Data->GetData() + HeaderSize, Data->Num() - HeaderSize) : TArrayView<const uint8>();
+        }
     };
+    using FTextureHandler = TFunction<void(FTextureId, const FTexture&)>;
 
     struct FEvent
     {
@@ -52,6 +78,14 @@ public:
             TakeControl = 11,
             PasteClipboard = 12,
             InputText = 13,
+            ReplayControl = 14,
+        };
+
+        enum EReplayCommand : int32
+        {
+            ReplayPlay = 0,
+            ReplayPause = 1,
+            ReplaySeek = 2,
         };
 
         EType Type = Unknown;
@@ -75,16 +109,52 @@ public:
 
         std::string ClipboardText;
         std::string InputtedText;
+
+        // ReplayControl, ReplayFrame is the frame index to seek to
+        int32 ReplayCommand = ReplayPlay;
+        int32 ReplayFrame = 0;
+    };
+
+    struct FCompression
+    {
+        // permessage-deflate zlib level 1..9, 0 disables it
+        int32 DeflateLevel = 0;
+        bool bLZ4Frame = false;
+        int32 MinCompressMessageSize = 1024;
+    };
+
+    struct FTextureCompression
+    {
+        // PNG encode textures whenever that makes them smaller
+        bool bLossless = true;
+        // textures with fewer pixel bytes are sent raw
+        int32 MinEncodeSize = 16 * 1024;
+        // JPEG quality 1..100 of opaque textures updated again within a second, such as render target previews, 0 keeps them lossless
+        int32 LossyQuality = 0;
     };
 
     ImGuiWS();
     ~ImGuiWS();
 
-    bool Init(int32 PortListen, const FString& PathOnDisk);
+    bool Init(int32 PortListen, const FString& PathOnDisk, const FCompression& Compression = {});
     bool Init(int32 PortListen, const FString& PathOnDisk, THandler&& ConnectHandler, THandler&& DisconnectHandler);
-    void Tick();
+    // blocks up to TimeoutMs waiting for client messages, WakeUp or the setters below return it early
+    void Tick(int32 TimeoutMs = 0);
+    void WakeUp();
     bool SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32 Width, int32 Height, const uint8* Data);
+    // textures with more than this share of changed 64x64 tiles are resent whole, 0 always resends them
+    void SetTextureMaxDirtyRatio(float Ratio);
+    // encoding is done on the thread pool, clients keep the previous revision until it finished
+    void SetTextureCompression(const FTextureCompression& Compression);
+    // drops the texture and tells the connected clients to delete it
+    void RemoveTexture(FTextureId TextureId);
+    // called inside Tick for every new texture revision
+    void SetTextureHandler(FTextureHandler&& Handler);
+    // the current textures, only valid on the thread calling Tick
+    void ForEachTexture(const FTextureHandler& Handler) const;
     bool SetDrawData(const struct ImDrawData* DrawData);
+    // resend every draw list each Interval frames, 0 only resends the changed ones
+    void SetDrawDataKeyframeInterval(int32 Interval);
     struct FDrawInfo
     {
         int32 MouseCursor = 0;
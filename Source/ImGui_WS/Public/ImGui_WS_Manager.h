@@ -25,6 +25,7 @@ public:
 	void Disable();
 	UFUNCTION(BlueprintCallable, Category = "ImGui")
 	int32 GetPort() const;
+	const struct FImGuiWSCompressionSettings& GetCompressionSettings() const;
 	UFUNCTION(BlueprintCallable, Category = "ImGui")
 	int32 GetConnectionCount() const;
 	UFUNCTION(BlueprintCallable, Category = "ImGui")
@@ -33,6 +34,8 @@ public:
 	bool IsRecording() const;
 	void StartRecord();
 	void StopRecord();
+	// write the frames held by the flight recorder (ImGui.WS.FlightRecorder) to the record directory
+	void DumpFlightRecorder(const FString& Reason);
 protected:
 	int32 DrawContextIndex = 0;
 	void Initialize(FSubsystemCollectionBase& Collection) override;
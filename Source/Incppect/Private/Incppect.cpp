@@ -4,6 +4,7 @@
 
 #include "LogIncppect.h"
 #include "WebSocketServer.h"
+#include "Misc/Compression.h"
 #include "Stats/Stats.h"
 
 DECLARE_STATS_GROUP (TEXT("Incppect"), STATGROUP_Incppect, STATCAT_Advanced);
@@ -14,11 +15,42 @@ namespace
     {
         return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
     }
+
+    // appends [TypeAll = 2][uncompressed size][compressed size][lz4 block][padding to 4 bytes]
+    // OutFrame is left untouched when compression doesn't pay off
+    bool AppendLZ4Frame(const TArray<uint8>& Message, TArray<uint8>& OutFrame)
+    {
+        constexpr int32 HeaderSize = 3 * sizeof(uint32);
+        const int32 FrameOffset = OutFrame.Num();
+        int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, Message.Num());
+        OutFrame.AddUninitialized(HeaderSize + CompressedSize + sizeof(uint32));
+        uint8* Frame = OutFrame.GetData() + FrameOffset;
+        if (FCompression::CompressMemory(NAME_LZ4, Frame + HeaderSize, CompressedSize, Message.GetData(), Message.Num()) == false)
+        {
+            OutFrame.SetNum(FrameOffset, EAllowShrinking::No);
+            return false;
+        }
+        const int32 FrameSize = Align(HeaderSize + CompressedSize, sizeof(uint32));
+        if (FrameSize >= Message.Num())
+        {
+            OutFrame.SetNum(FrameOffset, EAllowShrinking::No);
+            return false;
+        }
+
+        const uint32 Header[3] = { 2, (uint32)Message.Num(), (uint32)CompressedSize };
+        FMemory::Memcpy(Frame, Header, HeaderSize);
+        FMemory::Memzero(Frame + HeaderSize + CompressedSize, FrameSize - HeaderSize - CompressedSize);
+        OutFrame.SetNum(FrameOffset + FrameSize, EAllowShrinking::No);
+        return true;
+    }
 }
 
 struct FIncppect::FImpl
 {
     using FIpAddress = uint8[4];
+    // immutable once shared, clients with equal state point to the same buffer
+    // request data uses TBlob for the same purpose
+    using FDataRef = TSharedPtr<TArray<uint8>>;
 
     struct FRequest {
         int64 LastUpdatedMs = -1;
@@ -29,7 +61,12 @@ struct FIncppect::FImpl
         TIdxs Idxs;
         int32 GetterId = -1;
 
-        TArray<uint8> PrevData;
+        TBlob PrevData;
+
+        bool bStreamed = false;
+        // value being streamed and the size of it already sent
+        TBlob StreamData;
+        int32 StreamOffset = 0;
     };
 
     struct FClientData
@@ -41,7 +78,9 @@ struct FIncppect::FImpl
         TArray<int32> LastRequests;
         TMap<int32, FRequest> Requests;
 
-        TArray<uint8> PrevBuffer;
+        FDataRef PrevBuffer;
+        // recycled allocation for the next update buffer
+        TArray<uint8> SpareBuffer;
 
         struct FToServerEvent
         {
@@ -49,6 +88,15 @@ struct FIncppect::FImpl
             TArray<uint8> Payload;
         };
         TArray<FToServerEvent> ToServerEvents;
+
+        // events of messages still waiting in the socket queue, put back when those messages are dropped
+        struct FQueuedEvents
+        {
+            uint64 MessageIndex;
+            TArray<FToServerEvent> Events;
+        };
+        TArray<FQueuedEvents> QueuedEvents;
+        uint64 NumSentMessages = 0;
     };
 
     struct FPerSocketData
@@ -80,6 +128,11 @@ struct FIncppect::FImpl
             Mount.SetDefaultFile("index.html");
         }
         Server->EnableHTTPServer(Mounts);
+        if (Parameters.DeflateLevel > 0)
+        {
+            Server->EnablePerMessageDeflate(Parameters.DeflateLevel);
+        }
+        Server->SetWritableByteBudget(Parameters.WritableByteBudget);
         Server->SetFilterConnectionCallback(FWebSocketFilterConnectionCallback::CreateLambda([](FString OriginHeader, FString ClientIP)
         {
             return EWebsocketConnectionFilterResult::ConnectionAccepted;
@@ -135,11 +188,10 @@ struct FIncppect::FImpl
                 {
                     case 1:
                         {
+                            // legacy text registration: "path id nidxs idx..." separated by spaces
                             std::stringstream ss(static_cast<const char*>(RawData) + 4);
                             while (true)
                             {
-                                FRequest Request;
-
                                 std::string RawPath;
                                 ss >> RawPath;
                                 const FName Path{ UTF8_TO_TCHAR(RawPath.c_str()) };
@@ -148,38 +200,55 @@ struct FIncppect::FImpl
                                 ss >> RequestId;
                                 int32 IdxsNum = 0;
                                 ss >> IdxsNum;
-                                static const FName MyIdPath{ TEXT("my_id[%d]") };
-                                if (Path == MyIdPath)
+                                TIdxs Idxs;
+                                for (int32 I = 0; I < IdxsNum; ++I)
                                 {
-                                    for (int32 I = 0; I < IdxsNum; ++I)
-                                    {
-                                        int32 Idx = 0;
-                                        ss >> Idx;
-                                        if (Idx == -1) Idx = ClientId;
-                                        Request.Idxs.Add(Idx);
-                                    }
+                                    int32 Idx = 0;
+                                    ss >> Idx;
+                                    Idxs.Add(Idx);
                                 }
-                                else
+                                AddRequest(ClientId, ClientData, Path, RequestId, MoveTemp(Idxs));
+                            }
+                        }
+                        break;
+                    case 5:
+                        {
+                            // binary registration, little endian
+                            // [uint8 version][3 bytes padding] then per var:
+                            // [int32 request id][uint16 path size][uint16 idxs num][utf8 path][padding to 4 bytes][int32 idx...]
+                            constexpr uint8 BinaryRequestsVersion = 1;
+                            int32 Offset = sizeof(int32);
+                            if (Size < Offset + 4 || Data[Offset] != BinaryRequestsVersion)
+                            {
+                                UE_LOG(LogIncppect, Error, TEXT("error : unsupported requests version %d"), Size > Offset ? Data[Offset] : -1);
+                                return;
+                            }
+                            Offset += 4;
+                            while (Offset + 8 <= Size)
+                            {
+                                int32 RequestId = 0;
+                                uint16 PathSize = 0;
+                                uint16 IdxsNum = 0;
+                                FMemory::Memcpy(&RequestId, Data + Offset, sizeof(RequestId));
+                                FMemory::Memcpy(&PathSize, Data + Offset + 4, sizeof(PathSize));
+                                FMemory::Memcpy(&IdxsNum, Data + Offset + 6, sizeof(IdxsNum));
+                                Offset += 8;
+
+                                const int32 IdxsOffset = Align(Offset + PathSize, 4);
+                                if (IdxsOffset + IdxsNum * (int32)sizeof(int32) > Size)
                                 {
-                                    for (int32 I = 0; I < IdxsNum; ++I)
-                                    {
-                                        int32 Idx = 0;
-                                        ss >> Idx;
-                                        Request.Idxs.Add(Idx);
-                                    }
+                                    UE_LOG(LogIncppect, Error, TEXT("error : invalid message data!"));
+                                    return;
                                 }
 
-                                if (const int32* GetterIdx = PathToGetter.Find(Path))
-                                {
-                                    UE_LOG(LogIncppect, Verbose, TEXT("requestId = %d, path = '%s', nidxs = %d"), RequestId, *Path.ToString(), IdxsNum);
-                                    Request.GetterId = *GetterIdx;
+                                const FUTF8ToTCHAR RawPath{ reinterpret_cast<const ANSICHAR*>(Data + Offset), PathSize };
+                                const FName Path{ RawPath.Length(), RawPath.Get() };
+                                TIdxs Idxs;
+                                Idxs.SetNumUninitialized(IdxsNum);
+                                FMemory::Memcpy(Idxs.GetData(), Data + IdxsOffset, IdxsNum * sizeof(int32));
+                                Offset = IdxsOffset + IdxsNum * sizeof(int32);
 
-                                    ClientData.Requests.Emplace(RequestId, Request);
-                                }
-                                else
-                                {
-                                    UE_LOG(LogIncppect, Warning, TEXT("missing path '%s'"), *Path.ToString());
-                                }
+                                AddRequest(ClientId, ClientData, Path, RequestId, MoveTemp(Idxs));
                             }
                         }
                         break;
@@ -265,40 +334,226 @@ struct FIncppect::FImpl
         }
     }
 
-    void Update()
+    static int32 GetPaddingBytes(int32& DataSizeBytes)
     {
-        for (auto& [ClientId, ClientData] : ClientDataMap)
+        constexpr int32 kPadding = 4;
+
+        int32 PaddingBytes = 0;
         {
-            TArray<uint8> CurBuffer;
-            auto& PrevBuffer = ClientData.PrevBuffer;
+            int32 r = DataSizeBytes%kPadding;
+            while (r > 0 && r < kPadding)
+            {
+                ++DataSizeBytes;
+                ++PaddingBytes;
+                ++r;
+            }
+        }
+        return PaddingBytes;
+    }
+
+    // request payload without the [Type][RequestId] header, shared by every client with the same previous data
+    struct FEncodedRequest
+    {
+        int32 Type = 0;
+        TArray<uint8> Body;
+        // keeps the diff base alive, its address is part of the cache key
+        TBlob PrevData;
+    };
+
+    // per Update caches, each unique getter result, request diff and message is encoded once and copied to the clients
+    struct FUpdateCache
+    {
+        struct FGetterKey
+        {
+            int32 GetterId;
+            TIdxs Idxs;
 
+            bool operator==(const FGetterKey& Rhs) const { return GetterId == Rhs.GetterId && Idxs == Rhs.Idxs; }
+            friend uint32 GetTypeHash(const FGetterKey& Key)
             {
-                uint32 TypeAll = 0;
-                CurBuffer.Append(reinterpret_cast<uint8*>(&TypeAll), sizeof(TypeAll));
+                return HashCombine(::GetTypeHash(Key.GetterId), FCrc::MemCrc32(Key.Idxs.GetData(), Key.Idxs.Num() * sizeof(int32)));
             }
+        };
+        TMap<FGetterKey, TBlob> GetterResults;
+        TMap<TPair<const void*, const void*>, TSharedPtr<FEncodedRequest>> Requests;
+
+        // clients with the same previous buffer and the same update form a broadcast group
+        struct FMessage
+        {
+            // only compared, the client owning it holds the reference
+            const void* PrevBuffer;
+            FDataRef CurBuffer;
+            TArray<uint8> Encoded;
+        };
+        TArray<FMessage> Messages;
+    };
 
-            static auto GetPaddingBytes = [](int32& DataSizeBytes)
+    static void EncodeRequest(const TArray<uint8>& CurData, const TArray<uint8>* PrevData, FEncodedRequest& Out)
+    {
+        int32 DataSizeBytes = CurData.Num();
+        int32 PaddingBytes = GetPaddingBytes(DataSizeBytes);
+
+        Out.Type = 0; // full update
+        if (PrevData && PrevData->Num() == CurData.Num() + PaddingBytes && CurData.Num() > 256)
+        {
+            Out.Type = 1; // run-length encoding of diff
+        }
+
+        TArray<uint8>& Body = Out.Body;
+        if (Out.Type == 1 && PrevData == &CurData)
+        {
+            // same immutable blob as last time, the diff is a single run of zeros
+            const uint32 n = (CurData.Num() + 3) / 4;
+            const uint32 c = 0;
+            DataSizeBytes = sizeof(n) + sizeof(c);
+            Body.Append(reinterpret_cast<const uint8*>(&DataSizeBytes), sizeof(DataSizeBytes));
+            Body.Append(reinterpret_cast<const uint8*>(&n), sizeof(n));
+            Body.Append(reinterpret_cast<const uint8*>(&c), sizeof(c));
+        }
+        else if (Out.Type == 0)
+        {
+            Body.Append(reinterpret_cast<uint8*>(&DataSizeBytes), sizeof(DataSizeBytes));
+            Body.Append(CurData);
+            {
+                for (int32 i = 0; i < PaddingBytes; ++i)
+                {
+                    Body.Add(0);
+                }
+            }
+        }
+        else if (Out.Type == 1)
+        {
+            uint32 a = 0;
+            uint32 b = 0;
+            uint32 c = 0;
+            uint32 n = 0;
+            Body.AddZeroed(sizeof(DataSizeBytes));
+            for (int32 Idx = 0; Idx < CurData.Num(); Idx += 4)
             {
-                constexpr int32 kPadding = 4;
+                FMemory::Memcpy(&a, PrevData->GetData() + Idx, sizeof(a));
+                FMemory::Memcpy(&b, CurData.GetData() + Idx, sizeof(b));
+                a = a ^ b;
+                if (a == c)
+                {
+                    ++n;
+                }
+                else
+                {
+                    if (n > 0)
+                    {
+                        Body.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+                        Body.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+                    }
+                    n = 1;
+                    c = a;
+                }
+            }
 
-                int32 PaddingBytes = 0;
+            if (CurData.Num() % 4 != 0)
+            {
+                a = 0;
+                b = 0;
+                const uint32 Idx = (CurData.Num()/4)*4;
+                const uint32 k = CurData.Num() - Idx;
+                FMemory::Memcpy(&a, PrevData->GetData() + Idx, k);
+                FMemory::Memcpy(&b, CurData.GetData() + Idx, k);
+                a = a ^ b;
+                if (a == c)
                 {
-                    int32 r = DataSizeBytes%kPadding;
-                    while (r > 0 && r < kPadding)
+                    ++n;
+                }
+                else
+                {
+                    Body.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+                    Body.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+                    n = 1;
+                    c = a;
+                }
+            }
+
+            Body.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+            Body.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+
+            DataSizeBytes = Body.Num() - sizeof(DataSizeBytes);
+            FMemory::Memcpy(Body.GetData(), &DataSizeBytes, sizeof(DataSizeBytes));
+        }
+    }
+
+    void EncodeMessage(const TArray<uint8>& CurBuffer, const TArray<uint8>* PrevBuffer, TArray<uint8>& Out)
+    {
+        DECLARE_SCOPE_CYCLE_COUNTER(TEXT("Incppect_Diff"), STAT_Incppect_Diff, STATGROUP_Incppect);
+
+        const TArray<uint8>* Message = &CurBuffer;
+        if (PrevBuffer && CurBuffer.Num() == PrevBuffer->Num() && CurBuffer.Num() > 256)
+        {
+            DiffBuffer.Reset();
+            uint32 a = 0;
+            uint32 b = 0;
+            uint32 c = 0;
+            uint32 n = 0;
+
+            uint32 TypeAll = 1;
+            DiffBuffer.Append(reinterpret_cast<uint8*>(&TypeAll), sizeof(TypeAll));
+
+            for (int32 Idx = 4; Idx < (int32) CurBuffer.Num(); Idx += 4)
+            {
+                FMemory::Memcpy(&a, PrevBuffer->GetData() + Idx, sizeof(a));
+                FMemory::Memcpy(&b, CurBuffer.GetData() + Idx, sizeof(b));
+                a = a ^ b;
+                if (a == c)
+                {
+                    ++n;
+                }
+                else
+                {
+                    if (n > 0)
                     {
-                        ++DataSizeBytes;
-                        ++PaddingBytes;
-                        ++r;
+                        DiffBuffer.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+                        DiffBuffer.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
                     }
+                    n = 1;
+                    c = a;
                 }
-                return PaddingBytes;
-            };
+            }
+
+            DiffBuffer.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+            DiffBuffer.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+            Message = &DiffBuffer;
+        }
+
+        bool bFramed = false;
+        if (Parameters.bLZ4Frame && Message->Num() >= Parameters.MinCompressMessageSize)
+        {
+            DECLARE_SCOPE_CYCLE_COUNTER(TEXT("Incppect_Compress"), STAT_Incppect_Compress, STATGROUP_Incppect);
+            bFramed = AppendLZ4Frame(*Message, Out);
+        }
+        if (bFramed == false)
+        {
+            Out.Append(*Message);
+        }
+    }
+
+    void Update()
+    {
+        FUpdateCache Cache;
+
+        for (auto& [ClientId, ClientData] : ClientDataMap)
+        {
+            DropStaleUpdates(ClientId, ClientData);
+
+            TArray<uint8> CurBuffer = MoveTemp(ClientData.SpareBuffer);
+            CurBuffer.Reset();
+            auto& PrevBuffer = ClientData.PrevBuffer;
+
+            {
+                uint32 TypeAll = 0;
+                CurBuffer.Append(reinterpret_cast<uint8*>(&TypeAll), sizeof(TypeAll));
+            }
 
             for (auto& [RequestId, Req] : ClientData.Requests)
             {
                 DECLARE_SCOPE_CYCLE_COUNTER(TEXT("Incppect_Getter"), STAT_Incppect_Getter, STATGROUP_Incppect);
 
-                auto& Getter = Getters[Req.GetterId];
                 const int64 CurMS = ::TimeStamp();
                 if (((Req.LastRequestTimeoutMs < 0 && Req.LastRequestedMs > 0) || (CurMS - Req.LastRequestedMs < Req.LastRequestTimeoutMs)) &&
                     CurMS - Req.LastUpdatedMs > Req.MinUpdateMs)
@@ -308,91 +563,47 @@ struct FIncppect::FImpl
                         Req.LastRequestedMs = 0;
                     }
 
-                    const auto GetterData{ Getter(Req.Idxs) };
-                    TArrayView<uint8> CurData{ (uint8*)GetterData.data(), (int32)GetterData.size() };
-                    Req.LastUpdatedMs = CurMS;
-
-                    int32 DataSizeBytes = CurData.Num();
-                    int32 PaddingBytes = GetPaddingBytes(DataSizeBytes);
-
-                    int32 Type = 0; // full update
-                    if (Req.PrevData.Num() == CurData.Num() + PaddingBytes && CurData.Num() > 256)
-                    {
-                        Type = 1; // run-length encoding of diff
-                    }
-
-                    CurBuffer.Append(reinterpret_cast<uint8*>(&Type), sizeof(Type));
-                    CurBuffer.Append(reinterpret_cast<uint8*>(&RequestId), sizeof(RequestId));
-
-                    if (Type == 0)
+                    TBlob& CurData = Cache.GetterResults.FindOrAdd({ Req.GetterId, Req.Idxs });
+                    if (CurData.IsValid() == false)
                     {
-                        CurBuffer.Append(reinterpret_cast<uint8*>(&DataSizeBytes), sizeof(DataSizeBytes));
-                        CurBuffer.Append(CurData);
+                        auto& Getter = Getters[Req.GetterId];
+                        FResult GetterData{ Getter(Req.Idxs) };
+                        if (GetterData.Blob.IsValid())
                         {
-                            for (int32 i = 0; i < PaddingBytes; ++i)
-                            {
-                                CurBuffer.Add(0);
-                            }
+                            CurData = MoveTemp(GetterData.Blob);
                         }
-                    }
-                    else if (Type == 1)
-                    {
-                        uint32 a = 0;
-                        uint32 b = 0;
-                        uint32 c = 0;
-                        uint32 n = 0;
-                        TArray<uint8> DiffData;
-                        for (int32 Idx = 0; Idx < CurData.Num(); Idx += 4)
+                        else
                         {
-                            FMemory::Memcpy(&a, Req.PrevData.GetData() + Idx, sizeof(a));
-                            FMemory::Memcpy(&b, CurData.GetData() + Idx, sizeof(b));
-                            a = a ^ b;
-                            if (a == c)
-                            {
-                                ++n;
-                            }
-                            else
-                            {
-                                if (n > 0)
-                                {
-                                    DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                                    DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
-                                }
-                                n = 1;
-                                c = a;
-                            }
+                            // views may point into static storage reused by the next call, so they are copied once and shared
+                            CurData = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(reinterpret_cast<const uint8*>(GetterData.View.data()), (int32)GetterData.View.size());
                         }
+                    }
+                    Req.LastUpdatedMs = CurMS;
 
-                        if (CurData.Num() % 4 != 0)
+                    if (Req.bStreamed)
+                    {
+                        // streamed vars stay out of the update buffer, SendStreamChunks sends them behind it
+                        if (Req.PrevData != CurData && (Req.PrevData.IsValid() == false || *Req.PrevData != *CurData))
                         {
-                            a = 0;
-                            b = 0;
-                            const uint32 Idx = (CurData.Num()/4)*4;
-                            const uint32 k = CurData.Num() - Idx;
-                            FMemory::Memcpy(&a, Req.PrevData.GetData() + Idx, k);
-                            FMemory::Memcpy(&b, CurData.GetData() + Idx, k);
-                            a = a ^ b;
-                            if (a == c)
-                            {
-                                ++n;
-                            }
-                            else
-                            {
-                                DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                                DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
-                                n = 1;
-                                c = a;
-                            }
+                            Req.StreamData = CurData;
+                            Req.StreamOffset = 0;
                         }
+                        Req.PrevData = CurData;
+                        continue;
+                    }
 
-                        DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                        DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
-
-                        DataSizeBytes = DiffData.Num();
-                        CurBuffer.Append(reinterpret_cast<uint8*>(&DataSizeBytes), sizeof(DataSizeBytes));
-                        CurBuffer.Append(DiffData);
+                    TSharedPtr<FEncodedRequest>& Encoded = Cache.Requests.FindOrAdd(TPair<const void*, const void*>(CurData.Get(), Req.PrevData.Get()));
+                    if (Encoded.IsValid() == false)
+                    {
+                        Encoded = MakeShared<FEncodedRequest>();
+                        Encoded->PrevData = Req.PrevData;
+                        EncodeRequest(*CurData, Req.PrevData.Get(), *Encoded);
                     }
 
+                    CurBuffer.Append(reinterpret_cast<uint8*>(&Encoded->Type), sizeof(Encoded->Type));
+                    CurBuffer.Append(reinterpret_cast<const uint8*>(&RequestId), sizeof(RequestId));
+                    CurBuffer.Append(Encoded->Body);
+
                     Req.PrevData = CurData;
                 }
             }
@@ -415,75 +626,181 @@ struct FIncppect::FImpl
                         }
                     }
                 }
-                ClientData.ToServerEvents.Empty();
+                ClientData.QueuedEvents.Add({ ClientData.NumSentMessages, MoveTemp(ClientData.ToServerEvents) });
+                ClientData.ToServerEvents.Reset();
             }
 
             if (CurBuffer.Num() > 4)
             {
-                DECLARE_SCOPE_CYCLE_COUNTER(TEXT("Incppect_Diff"), STAT_Incppect_Diff, STATGROUP_Incppect);
-
-                if (CurBuffer.Num() == PrevBuffer.Num() && CurBuffer.Num() > 256)
+                FUpdateCache::FMessage* Message = Cache.Messages.FindByPredicate([&](const FUpdateCache::FMessage& Other)
+                {
+                    return Other.PrevBuffer == PrevBuffer.Get() && Other.CurBuffer->Num() == CurBuffer.Num() &&
+                        FMemory::Memcmp(Other.CurBuffer->GetData(), CurBuffer.GetData(), CurBuffer.Num()) == 0;
+                });
+                if (Message == nullptr)
                 {
-                    TArray<uint8> DiffBuffer;
-                    uint32 a = 0;
-                    uint32 b = 0;
-                    uint32 c = 0;
-                    uint32 n = 0;
+                    Message = &Cache.Messages.AddDefaulted_GetRef();
+                    Message->PrevBuffer = PrevBuffer.Get();
+                    EncodeMessage(CurBuffer, PrevBuffer.Get(), Message->Encoded);
+                    Message->CurBuffer = MakeShared<TArray<uint8>>(MoveTemp(CurBuffer));
+                }
 
-                    uint32 TypeAll = 1;
-                    DiffBuffer.Append(reinterpret_cast<uint8*>(&TypeAll), sizeof(TypeAll));
+                Send(ClientId, Message->Encoded);
+                ClientData.NumSentMessages += 1;
 
-                    for (int32 Idx = 4; Idx < (int32) CurBuffer.Num(); Idx += 4)
-                    {
-                        FMemory::Memcpy(&a, PrevBuffer.GetData() + Idx, sizeof(a));
-                        FMemory::Memcpy(&b, CurBuffer.GetData() + Idx, sizeof(b));
-                        a = a ^ b;
-                        if (a == c)
-                        {
-                            ++n;
-                        }
-                        else
-                        {
-                            if (n > 0)
-                            {
-                                DiffBuffer.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                                DiffBuffer.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
-                            }
-                            n = 1;
-                            c = a;
-                        }
-                    }
+                TxTotalBytes += Message->CurBuffer->Num();
+
+                // recycle the previous buffer when no other client shares it
+                if (PrevBuffer.IsValid() && PrevBuffer.IsUnique())
+                {
+                    ClientData.SpareBuffer = MoveTemp(*PrevBuffer);
+                }
+                PrevBuffer = Message->CurBuffer;
+            }
+            else
+            {
+                ClientData.SpareBuffer = MoveTemp(CurBuffer);
+            }
 
-                    DiffBuffer.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                    DiffBuffer.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+            SendStreamChunks(ClientId, ClientData);
+        }
+    }
 
-                    if (SocketDataMap[ClientId].Socket->Send(DiffBuffer.GetData(), DiffBuffer.Num(), false) == false)
-                    {
-                        UE_LOG(LogIncppect, Warning, TEXT("backpressure for client %d increased"), ClientId);
-                    }
+    // [TypeAll = 3][request id][total size][offset][chunk size][chunk][padding to 4 bytes]
+    // chunks are self-contained messages, the client assembles them apart from the update diffs
+    void SendStreamChunks(int32 ClientId, FClientData& ClientData)
+    {
+        const Incppect::FWebSocketSendQueue& Queue = SocketDataMap[ClientId].Socket->OutgoingBuffer;
+        for (auto& [RequestId, Req] : ClientData.Requests)
+        {
+            while (Req.StreamData.IsValid())
+            {
+                if (Queue.NumBytes() >= Parameters.MaxStreamQueuedBytes)
+                {
+                    return;
                 }
-                else
+
+                DECLARE_SCOPE_CYCLE_COUNTER(TEXT("Incppect_Stream"), STAT_Incppect_Stream, STATGROUP_Incppect);
+
+                const int32 TotalSize = Req.StreamData->Num();
+                const int32 ChunkSize = FMath::Min(FMath::Max(Parameters.StreamChunkSize, 4), TotalSize - Req.StreamOffset);
+                const int32 Header[5] = { 3, RequestId, TotalSize, Req.StreamOffset, ChunkSize };
+                ChunkBuffer.Reset();
+                ChunkBuffer.Append(reinterpret_cast<const uint8*>(Header), sizeof(Header));
+                ChunkBuffer.Append(Req.StreamData->GetData() + Req.StreamOffset, ChunkSize);
+                ChunkBuffer.AddZeroed(Align(ChunkBuffer.Num(), 4) - ChunkBuffer.Num());
+
+                EncodedChunk.Reset();
+                EncodeMessage(ChunkBuffer, nullptr, EncodedChunk);
+                Send(ClientId, EncodedChunk);
+                ClientData.NumSentMessages += 1;
+                TxTotalBytes += ChunkBuffer.Num();
+
+                Req.StreamOffset += ChunkSize;
+                if (Req.StreamOffset >= TotalSize)
                 {
-                    if (SocketDataMap[ClientId].Socket->Send(CurBuffer.GetData(), CurBuffer.Num(), false) == false)
-                    {
-                        UE_LOG(LogIncppect, Warning, TEXT("backpressure for client %d increased"), ClientId);
-                    }
+                    Req.StreamData.Reset();
                 }
+            }
+        }
+    }
+
+    void AddRequest(int32 ClientId, FClientData& ClientData, const FName& Path, int32 RequestId, TIdxs&& Idxs)
+    {
+        static const FName MyIdPath{ TEXT("my_id[%d]") };
+        if (Path == MyIdPath)
+        {
+            for (int32& Idx : Idxs)
+            {
+                if (Idx == -1) Idx = ClientId;
+            }
+        }
+
+        if (const int32* GetterIdx = PathToGetter.Find(Path))
+        {
+            UE_LOG(LogIncppect, Verbose, TEXT("requestId = %d, path = '%s', nidxs = %d"), RequestId, *Path.ToString(), Idxs.Num());
+            FRequest Request;
+            Request.GetterId = *GetterIdx;
+            Request.bStreamed = StreamedGetters[*GetterIdx];
+            Request.Idxs = MoveTemp(Idxs);
 
-                TxTotalBytes += CurBuffer.Num();
+            ClientData.Requests.Emplace(RequestId, MoveTemp(Request));
+        }
+        else
+        {
+            UE_LOG(LogIncppect, Warning, TEXT("missing path '%s'"), *Path.ToString());
+        }
+    }
+
+    // latest frame wins, when a client can't keep up its queued updates are replaced by a self-contained newest one
+    void DropStaleUpdates(int32 ClientId, FClientData& ClientData)
+    {
+        Incppect::FWebSocketSendQueue& Queue = SocketDataMap[ClientId].Socket->OutgoingBuffer;
 
-                PrevBuffer = MoveTemp(CurBuffer);
+        // messages already written don't need their events anymore
+        const uint64 FirstQueuedMessage = ClientData.NumSentMessages - Queue.Num();
+        ClientData.QueuedEvents.RemoveAll([FirstQueuedMessage](const FClientData::FQueuedEvents& QueuedEvents)
+        {
+            return QueuedEvents.MessageIndex < FirstQueuedMessage;
+        });
+
+        if (Queue.Num() <= Parameters.MaxQueuedMessages && Queue.NumBytes() <= Parameters.MaxQueuedBytes)
+        {
+            return;
+        }
+
+        UE_LOG(LogIncppect, Verbose, TEXT("client %d can't keep up, dropping %d queued updates (%lld bytes)"), ClientId, Queue.Num() - 1, Queue.NumBytes());
+
+        // the oldest message is kept so a client on a slow link still gets a frame through
+        Queue.Truncate(1);
+
+        TArray<FClientData::FToServerEvent> DroppedEvents;
+        for (FClientData::FQueuedEvents& QueuedEvents : ClientData.QueuedEvents)
+        {
+            if (QueuedEvents.MessageIndex != FirstQueuedMessage)
+            {
+                DroppedEvents.Append(MoveTemp(QueuedEvents.Events));
             }
         }
+        ClientData.QueuedEvents.RemoveAll([FirstQueuedMessage](const FClientData::FQueuedEvents& QueuedEvents)
+        {
+            return QueuedEvents.MessageIndex != FirstQueuedMessage;
+        });
+        DroppedEvents.Append(MoveTemp(ClientData.ToServerEvents));
+        ClientData.ToServerEvents = MoveTemp(DroppedEvents);
+        ClientData.NumSentMessages = FirstQueuedMessage + Queue.Num();
+
+        // the client never sees the dropped updates, so the next one must not be diffed against them
+        ClientData.PrevBuffer.Reset();
+        for (auto& [RequestId, Req] : ClientData.Requests)
+        {
+            Req.PrevData.Reset();
+            // dropped chunks leave the client with a partial value, the next update restarts the stream
+            Req.StreamData.Reset();
+        }
+    }
+
+    void Send(int32 ClientId, const TArray<uint8>& Message)
+    {
+        Incppect::FWebSocket* Socket = SocketDataMap[ClientId].Socket;
+        Socket->BeginSend().Append(Message);
+        Socket->CommitSend();
     }
 
     FParameters Parameters;
 
+    // scratch buffer of the whole update diff, reused between messages
+    TArray<uint8> DiffBuffer;
+    // scratch buffers of the stream chunks
+    TArray<uint8> ChunkBuffer;
+    TArray<uint8> EncodedChunk;
+
     double TxTotalBytes = 0;
     double RxTotalBytes = 0;
 
     TMap<TPath, int32> PathToGetter;
     TArray<TGetter> Getters;
+    TArray<bool> StreamedGetters;
 
     TMap<int32, FPerSocketData> SocketDataMap;
     TMap<int32, FClientData> ClientDataMap;
@@ -517,9 +834,22 @@ void FIncppect::Init(const FParameters& Parameters)
     Impl->Init();
 }
 
-void FIncppect::Tick()
+void FIncppect::Tick(int32 TimeoutMs)
 {
-    Impl->Server->Tick();
+    Impl->Server->Tick(TimeoutMs);
+    // keep the streams going between client requests as the send queues drain
+    for (auto& [ClientId, ClientData] : Impl->ClientDataMap)
+    {
+        Impl->SendStreamChunks(ClientId, ClientData);
+    }
+}
+
+void FIncppect::WakeUp()
+{
+    if (Impl && Impl->Server)
+    {
+        Impl->Server->WakeUp();
+    }
 }
 
 void FIncppect::Stop()
@@ -536,6 +866,13 @@ void FIncppect::Var(const TPath& Path, TGetter&& Getter)
 {
     Impl->PathToGetter.Add(Path, Impl->Getters.Num());
     Impl->Getters.Emplace(Getter);
+    Impl->StreamedGetters.Add(false);
+}
+
+void FIncppect::StreamVar(const TPath& Path, TGetter&& Getter)
+{
+    Var(Path, MoveTemp(Getter));
+    Impl->StreamedGetters.Last() = true;
 }
 
 void FIncppect::ServerEvent(int32 ClientId, int32 EventId, TArray<uint8>&& Payload)
@@ -162,13 +162,81 @@ FWebSocket::FWebSocket(WebSocketInternalContext* InContext, WebSocketInternal* I
 }
 #endif
 
-bool FWebSocket::Send(const uint8* Data, uint32 Size, bool bPrependSize)
+int32 FWebSocketSendQueue::GetHeadroom()
 {
-	TArray<uint8> Buffer;
-
 #if USE_LIBWEBSOCKET
-	Buffer.AddDefaulted(LWS_PRE); // Reserve space for WS header data
+	return LWS_PRE; // Reserve space for WS header data
+#else
+	return 0;
 #endif
+}
+
+TArray<uint8>& FWebSocketSendQueue::Reserve()
+{
+	if (Count == Slots.Num())
+	{
+		// grow and unwrap the ring, the recycled buffers are moved so their allocations are kept
+		TArray<TArray<uint8>> NewSlots;
+		NewSlots.SetNum(FMath::Max(8, Slots.Num() * 2));
+		for (int32 Idx = 0; Idx < Count; ++Idx)
+		{
+			NewSlots[Idx] = MoveTemp(Slots[(Head + Idx) % Slots.Num()]);
+		}
+		Slots = MoveTemp(NewSlots);
+		Head = 0;
+	}
+
+	TArray<uint8>& Slot = Slots[(Head + Count) % Slots.Num()];
+	Slot.SetNumUninitialized(GetHeadroom(), EAllowShrinking::No);
+	return Slot;
+}
+
+void FWebSocketSendQueue::Commit()
+{
+	check(Count < Slots.Num());
+	QueuedBytes += Slots[(Head + Count) % Slots.Num()].Num() - GetHeadroom();
+	Count += 1;
+}
+
+TArray<uint8>* FWebSocketSendQueue::Peek()
+{
+	return Count > 0 ? &Slots[Head] : nullptr;
+}
+
+void FWebSocketSendQueue::Pop()
+{
+	check(Count > 0);
+	TArray<uint8>& Slot = Slots[Head];
+	QueuedBytes -= Slot.Num() - GetHeadroom();
+	Recycle(Slot);
+	Head = (Head + 1) % Slots.Num();
+	Count -= 1;
+}
+
+void FWebSocketSendQueue::Truncate(int32 NumToKeep)
+{
+	while (Count > FMath::Max(NumToKeep, 0))
+	{
+		TArray<uint8>& Slot = Slots[(Head + Count - 1) % Slots.Num()];
+		QueuedBytes -= Slot.Num() - GetHeadroom();
+		Recycle(Slot);
+		Count -= 1;
+	}
+}
+
+void FWebSocketSendQueue::Recycle(TArray<uint8>& Slot)
+{
+	// don't let a single huge message pin its memory for the lifetime of the connection
+	constexpr int32 MaxPooledSlotBytes = 4 * 1024 * 1024;
+	if (Slot.Max() > MaxPooledSlotBytes)
+	{
+		Slot.Empty();
+	}
+}
+
+bool FWebSocket::Send(const uint8* Data, uint32 Size, bool bPrependSize)
+{
+	TArray<uint8>& Buffer = OutgoingBuffer.Reserve();
 
 	if (bPrependSize)
 	{
@@ -176,11 +244,23 @@ bool FWebSocket::Send(const uint8* Data, uint32 Size, bool bPrependSize)
 	}
 
 	Buffer.Append((uint8*)Data, Size);
-	OutgoingBuffer.Add(Buffer);
+	CommitSend();
 
 	return true;
 }
 
+void FWebSocket::CommitSend()
+{
+	OutgoingBuffer.Commit();
+#if USE_LIBWEBSOCKET
+	// start writing on the current service pass instead of waiting for the next tick
+	if (IsServerSide)
+	{
+		lws_callback_on_writable(Wsi);
+	}
+#endif
+}
+
 void FWebSocket::SetReceiveCallBack(FWebSocketPacketReceivedCallBack CallBack)
 {
 	ReceivedCallback = CallBack;
@@ -411,22 +491,58 @@ void FWebSocket::OnRawRecieve(void* Data, uint32 Size)
 
 void FWebSocket::OnRawWebSocketWritable(WebSocketInternal* wsi)
 {
-	if (OutgoingBuffer.Num() == 0)
-		return;
+#if USE_LIBWEBSOCKET
+	check(Wsi == wsi);
+#endif
 
-	TArray <uint8>& Packet = OutgoingBuffer[0];
+	// keep writing while the socket accepts data, whatever is left over goes out on the next writable callback
+	// with an extension one write per callback, a second one while it drains would continue the previous message
+	int64 BytesWritten = 0;
+	while (TArray<uint8>* Packet = OutgoingBuffer.Peek())
+	{
+		if (WritePacket(*Packet) == false)
+		{
+			return;
+		}
+		BytesWritten += Packet->Num();
 
+		// the slot keeps its allocation for the next message
+		OutgoingBuffer.Pop();
+
+		if (WritableByteBudget > 0 && BytesWritten >= WritableByteBudget)
+		{
+			break;
+		}
+#if USE_LIBWEBSOCKET
+		if (bExtensionActive || lws_send_pipe_choked(Wsi))
+		{
+			break;
+		}
+#endif
+	}
+
+#if USE_LIBWEBSOCKET
+	// client side sockets are re-armed by the protocol callback
+	if (IsServerSide && OutgoingBuffer.Num() > 0)
+	{
+		lws_callback_on_writable(Wsi);
+	}
+#endif
+}
+
+bool FWebSocket::WritePacket(const TArray<uint8>& Packet)
+{
 #if USE_LIBWEBSOCKET
 
 	uint32 TotalDataSize = Packet.Num() - LWS_PRE;
 	uint32 DataToSend = TotalDataSize;
 	while (DataToSend)
 	{
-		int Sent = lws_write(Wsi, Packet.GetData() + LWS_PRE + (DataToSend-TotalDataSize), DataToSend, (lws_write_protocol)LWS_WRITE_BINARY);
+		int Sent = lws_write(Wsi, const_cast<uint8*>(Packet.GetData()) + LWS_PRE + (TotalDataSize - DataToSend), DataToSend, (lws_write_protocol)LWS_WRITE_BINARY);
 		if (Sent < 0)
 		{
 			ErrorCallBack.ExecuteIfBound();
-			return;
+			return false;
 		}
 		if ((uint32)Sent < DataToSend)
 		{
@@ -435,8 +551,6 @@ void FWebSocket::OnRawWebSocketWritable(WebSocketInternal* wsi)
 		DataToSend-=Sent;
 	}
 
-	check(Wsi == wsi);
-
 #else // ! USE_LIBWEBSOCKET -- HTML5 uses BSD network API
 
 	uint32 TotalDataSize = Packet.Num();
@@ -444,13 +558,13 @@ void FWebSocket::OnRawWebSocketWritable(WebSocketInternal* wsi)
 	while (DataToSend)
 	{
 		// send actual data in one go.
-		int Result = send(SockFd, Packet.GetData()+(DataToSend-TotalDataSize),DataToSend, 0);
+		int Result = send(SockFd, Packet.GetData() + (TotalDataSize - DataToSend), DataToSend, 0);
 		if (Result == -1)
 		{
 			// we are caught with our pants down. fail.
 			UE_LOG(LogIncppect, Error, TEXT("Could not write %d bytes"), Packet.Num());
 			ErrorCallBack.ExecuteIfBound();
-			return;
+			return false;
 		}
 		UE_CLOG((uint32)Result < DataToSend, LogIncppect, Warning, TEXT("Could not write all '%d' bytes to socket"), DataToSend);
 		DataToSend-=Result;
@@ -458,9 +572,7 @@ void FWebSocket::OnRawWebSocketWritable(WebSocketInternal* wsi)
 
 #endif
 
-	// this is very inefficient we need a constant size circular buffer to efficiently not do unnecessary allocations/deallocations.
-	OutgoingBuffer.RemoveAt(0);
-
+	return true;
 }
 
 void FWebSocket::OnClose()
@@ -633,6 +745,20 @@ void FWebSocketServer::EnableHTTPServer(TArray<FWebSocketHttpMount> InDirectorie
 #endif
 }
 
+void FWebSocketServer::SetWritableByteBudget(int32 ByteBudget)
+{
+	WritableByteBudget = FMath::Max(ByteBudget, 0);
+}
+
+void FWebSocketServer::EnablePerMessageDeflate(int32 CompressionLevel)
+{
+#if USE_LIBWEBSOCKET && !defined(LWS_WITHOUT_EXTENSIONS)
+	DeflateLevel = FMath::Clamp(CompressionLevel, 1, 9);
+#else
+	UE_LOG(LogIncppect, Warning, TEXT("permessage-deflate is not supported by this libwebsockets build"));
+#endif
+}
+
 bool FWebSocketServer::Init(uint32 Port, FWebSocketClientConnectedCallBack CallBack, FString BindAddress)
 {
 #if USE_LIBWEBSOCKET
@@ -671,8 +797,21 @@ bool FWebSocketServer::Init(uint32 Port, FWebSocketClientConnectedCallBack CallB
 	}
 
 	Info.protocols = &Protocols[0];
+#if !defined(LWS_WITHOUT_EXTENSIONS)
+	static const lws_extension Extensions[] =
+	{
+		{
+			"permessage-deflate",
+			lws_extension_callback_pm_deflate,
+			"permessage-deflate"
+		},
+		{ NULL, NULL, NULL }
+	};
+	Info.extensions = DeflateLevel > 0 ? Extensions : NULL;
+#else
 	// no extensions
 	Info.extensions = NULL;
+#endif
 	Info.gid = -1;
 	Info.uid = -1;
 	Info.options = LWS_SERVER_OPTION_ALLOW_LISTEN_SHARE;
@@ -795,14 +934,24 @@ void FWebSocketServer::SetFilterConnectionCallback(FWebSocketFilterConnectionCal
 	FilterConnectionCallback = MoveTemp(InFilterConnectionCallback);
 }
 
-void FWebSocketServer::Tick()
+void FWebSocketServer::Tick(int32 TimeoutMs)
 {
 #if USE_LIBWEBSOCKET
-	lws_service(Context, 0);
+	lws_service(Context, TimeoutMs);
 	lws_callback_on_writable_all_protocol(Context, &Protocols[0]);
 #endif
 }
 
+void FWebSocketServer::WakeUp()
+{
+#if USE_LIBWEBSOCKET
+	if (Context)
+	{
+		lws_cancel_service(Context);
+	}
+#endif
+}
+
 FWebSocketServer::~FWebSocketServer()
 {
 #if USE_LIBWEBSOCKET
@@ -852,7 +1001,17 @@ static int unreal_networking_server
 		case LWS_CALLBACK_ESTABLISHED:
 			{
 				BufferInfo->Socket = new FWebSocket(Context, Wsi);
+				BufferInfo->Socket->WritableByteBudget = Server->GetWritableByteBudget();
 				BufferInfo->FragementationState = EFragmentationState::BeginFrame;
+#if !defined(LWS_WITHOUT_EXTENSIONS)
+				if (Server->GetDeflateLevel() > 0)
+				{
+					// fails when the client didn't accept the extension
+					char Level[4];
+					FCStringAnsi::Sprintf(Level, "%d", Server->GetDeflateLevel());
+					BufferInfo->Socket->bExtensionActive = lws_set_extension_option(Wsi, "permessage-deflate", "compression_level", Level) == 0;
+				}
+#endif
 				Server->ConnectedCallBack.ExecuteIfBound(BufferInfo->Socket);
 				lws_set_timeout(Wsi, NO_PENDING_TIMEOUT, 0);
 			}
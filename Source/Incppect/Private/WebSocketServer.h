@@ -73,6 +73,40 @@ DECLARE_DELEGATE_TwoParams(FWebSocketPacketReceivedCallBack, void* /*Data*/, int
 DECLARE_DELEGATE_OneParam(FWebSocketClientConnectedCallBack, class FWebSocket* /*Socket*/);
 DECLARE_DELEGATE_RetVal_TwoParams(EWebsocketConnectionFilterResult, FWebSocketFilterConnectionCallback, FString /*Origin*/, FString /*ClientIP*/);
 
+/**
+ * Ring of reusable outgoing messages. Every slot keeps the libwebsockets header room (LWS_PRE) in front
+ * of its payload, so producers serialize straight into it and lws_write needs no extra copy.
+ * Slot buffers keep their allocation when recycled.
+ */
+class FWebSocketSendQueue
+{
+public:
+	/** Returns the next free slot, it only contains the header room. Append the payload then call Commit. */
+	TArray<uint8>& Reserve();
+	void Commit();
+	/** Oldest queued message including the header room, nullptr when empty. */
+	TArray<uint8>* Peek();
+	/** Recycle the oldest queued message. */
+	void Pop();
+	/** Drop the newest queued messages so that at most NumToKeep of the oldest are left. */
+	void Truncate(int32 NumToKeep);
+
+	int32 Num() const { return Count; }
+	bool IsEmpty() const { return Count == 0; }
+	/** Payload bytes waiting to be written, without the header room. */
+	int64 NumBytes() const { return QueuedBytes; }
+
+	static int32 GetHeadroom();
+
+private:
+	static void Recycle(TArray<uint8>& Slot);
+
+	TArray<TArray<uint8>> Slots;
+	int32 Head = 0;
+	int32 Count = 0;
+	int64 QueuedBytes = 0;
+};
+
 class FWebSocket
 {
 
@@ -93,6 +127,9 @@ public:
 	void SetReceiveCallBack(FWebSocketPacketReceivedCallBack CallBack);
 	void SetSocketClosedCallBack(FWebSocketInfoCallBack CallBack);
 	bool Send(const uint8* Data, uint32 Size, bool bPrependSize = true);
+	/** Zero-copy send, append the message to the returned buffer then call CommitSend. */
+	TArray<uint8>& BeginSend() { return OutgoingBuffer.Reserve(); }
+	void CommitSend();
 	void Tick();
 	void Flush();
 	TArray<uint8> GetRawRemoteAddr(int32& OutPort);
@@ -107,6 +144,7 @@ public:
 	void OnReceive(void* Data, uint32 Size);
 	void OnRawRecieve(void* Data, uint32 Size);
 	void OnRawWebSocketWritable(WebSocketInternal* wsi);
+	bool WritePacket(const TArray<uint8>& Packet);
 	void OnClose();
 
 	/************************************************************************/
@@ -119,7 +157,11 @@ public:
 
 	/**  Recv and Send Buffers, serviced during the Tick */
 	TArray<uint8> ReceiveBuffer;
-	TArray<TArray<uint8>> OutgoingBuffer;
+	FWebSocketSendQueue OutgoingBuffer;
+	/** Max bytes written per writable callback before yielding to other connections, 0 is unlimited */
+	int32 WritableByteBudget = 0;
+	/** An extension like permessage-deflate is active, libwebsockets then allows a single lws_write per writable callback */
+	bool bExtensionActive = false;
 
 #if USE_LIBWEBSOCKET
 	/** libwebsocket internal context*/
@@ -150,13 +192,22 @@ public:
 	//~ Begin IWebSocketServer interface
 	~FWebSocketServer();
 	void EnableHTTPServer(TArray<FWebSocketHttpMount> DirectoriesToServe);
+	/** Negotiate permessage-deflate with clients, must be called before Init. CompressionLevel is the zlib level 1..9 */
+	void EnablePerMessageDeflate(int32 CompressionLevel);
+	/** Max bytes written to one connection per writable callback, 0 writes until the socket chokes */
+	void SetWritableByteBudget(int32 ByteBudget);
 	bool Init(uint32 Port, FWebSocketClientConnectedCallBack, FString BindAddress = TEXT(""));
 	void SetFilterConnectionCallback(FWebSocketFilterConnectionCallback InFilterConnectionCallback);
-	void Tick();
+	/** Services the sockets, waits up to TimeoutMs for socket activity or a WakeUp */
+	void Tick(int32 TimeoutMs = 0);
+	/** Makes a blocking Tick return early, can be called from any thread */
+	void WakeUp();
 	FString Info();
 	//~ End IWebSocketServer interface
 
 	bool IsHttpEnabled() const;
+	int32 GetDeflateLevel() const { return DeflateLevel; }
+	int32 GetWritableByteBudget() const { return WritableByteBudget; }
 
 	// this was made public because of cross-platform build issues
 	public:
@@ -178,6 +229,8 @@ public:
 
 private:
 	bool bEnableHttp = false;
+	int32 DeflateLevel = 0;
+	int32 WritableByteBudget = 0;
 
 	TArray<FWebSocketHttpMount> DirectoriesToServe;
 	WebSocketInternalHttpMount* LwsHttpMounts = NULL;
@@ -23,7 +23,21 @@ public:
     using TUrl = FName;
     using TPath = FName;
     using TIdxs = TArray<int32>;
-    using TGetter = TFunction<std::string_view(const TIdxs& /*idxs*/)>;
+    // immutable ref-counted data, getters can hand it out without copying
+    using TBlob = TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>;
+
+    // getter result, either a view the getter keeps valid until its next call (copied once per update)
+    // or a blob that is shared as is until the clients have been sent it
+    struct FResult
+    {
+        FResult() = default;
+        FResult(std::string_view InView) : View(InView) {}
+        FResult(const TBlob& InBlob) : Blob(InBlob) {}
+
+        std::string_view View;
+        TBlob Blob;
+    };
+    using TGetter = TFunction<FResult(const TIdxs& /*idxs*/)>;
     using THandler = TFunction<void(int32 /*ClientId*/, EventType /*EventType*/, TArrayView<const uint8>)>;
 
     // service parameters
@@ -35,6 +49,22 @@ public:
 
         FString HttpRoot = ".";
         FString PathOnDisk;
+
+        // permessage-deflate zlib level 1..9, 0 disables the extension
+        int32 DeflateLevel = 0;
+        // wrap update messages into lz4 frames, decoded by incppect.js
+        bool bLZ4Frame = false;
+        // update messages smaller than this are never lz4 framed
+        int32 MinCompressMessageSize = 1024;
+        // bytes written to one client per writable callback before yielding, 0 writes until the socket chokes
+        int32 WritableByteBudget = 1024 * 1024;
+        // per client send queue limits, above either one the queued updates are dropped in favor of the newest
+        int32 MaxQueuedMessages = 8;
+        int64 MaxQueuedBytes = 32 * 1024 * 1024;
+        // streamed vars are sent in chunks of this size, each one a message of its own behind the updates
+        int32 StreamChunkSize = 64 * 1024;
+        // chunks are only queued while less than this is waiting for the client, so an update never waits behind more
+        int32 MaxStreamQueuedBytes = 128 * 1024;
     };
 
     FIncppect();
@@ -44,7 +74,11 @@ public:
     // blocking call
     void Init(const FParameters& Parameters);
 
-    void Tick();
+    // service the clients, blocks up to TimeoutMs until a client message arrives or WakeUp is called
+    void Tick(int32 TimeoutMs = 0);
+
+    // make a blocking Tick return, thread safe
+    void WakeUp();
 
     // terminate the server instance
     void Stop();
@@ -61,6 +95,9 @@ public:
     //   Var("path2[%d].foo[%d]", [](auto idxs) { ... idxs[0], idxs[1] ... });
     //
     void Var(const TPath& Path, TGetter&& Getter);
+    // same as Var for large, rarely changing data, a new value is streamed in chunks on a lower priority
+    // channel instead of the update message and the client keeps the previous value until the last chunk
+    void StreamVar(const TPath& Path, TGetter&& Getter);
     // direct send event to server
     void ServerEvent(int32 ClientId, int32 EventId, TArray<uint8>&& Payload);
 